@@ -0,0 +1,55 @@
+#include "alias_table.h"
+
+/*
+ * Function to build the alias table (Vose's method)
+ * Arguments: weights, number of weights
+ * Returns: Total weight
+ */
+double AliasTable::build(const double *weights, std::size_t k)
+{
+  prob.resize(k);
+  alias.resize(k);
+
+  double total = 0.0;
+  for (std::size_t i = 0; i < k; ++i)
+    total += weights[i];
+  if (total <= 0.0)
+    return total;
+
+  // Scale weights so the average slot holds exactly 1
+  small.clear();
+  large.clear();
+  double scale = k / total;
+  for (std::size_t i = 0; i < k; ++i)
+  {
+    prob[i] = weights[i] * scale;
+    alias[i] = i;
+    if (prob[i] < 1.0)
+      small.push_back(i);
+    else
+      large.push_back(i);
+  }
+
+  // Top up each small slot from a large one
+  while (!small.empty() && !large.empty())
+  {
+    uint32_t s = small.back();
+    uint32_t l = large.back();
+    small.pop_back();
+    alias[s] = l;
+    prob[l] -= 1.0 - prob[s];
+    if (prob[l] < 1.0)
+    {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+
+  // Whatever is left is full up to rounding error
+  for (uint32_t l : large)
+    prob[l] = 1.0;
+  for (uint32_t s : small)
+    prob[s] = 1.0;
+
+  return total;
+}
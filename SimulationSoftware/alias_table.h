@@ -0,0 +1,39 @@
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+
+#include "aligned_array.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Walker/Vose alias table: O(k) to build over k weights, O(1) per weighted draw
+class AliasTable
+{
+private:
+  AlignedArray<double> prob; // Chance of keeping the slot drawn
+  AlignedArray<uint32_t> alias; // Slot taken otherwise
+  std::vector<uint32_t> small; // Build scratch, slots below the mean weight
+  std::vector<uint32_t> large; // Build scratch, slots at or above the mean weight
+
+public:
+  // Build from k weights, returns the total weight (no draws are possible if it is 0)
+  double build(const double *weights, std::size_t k);
+
+  std::size_t size() const { return prob.size(); }
+
+  // Weighted draw from a uniform double in [0, 1), which picks both the slot and the coin flip
+  uint32_t pick(double u) const
+  {
+    u *= prob.size();
+    uint32_t slot = uint32_t(u);
+    if (slot >= prob.size())
+      slot = prob.size() - 1;
+    return (u - slot < prob[slot]) ? slot : alias[slot];
+  }
+
+  // Weighted draw using a random number generator
+  template <typename RNG>
+  uint32_t sample(RNG &rng) const { return pick(rng.GetDouble()); }
+};
+
+#endif
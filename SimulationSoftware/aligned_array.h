@@ -0,0 +1,104 @@
+#ifndef ALIGNED_ARRAY_H
+#define ALIGNED_ARRAY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Runtime-sized heap array aligned to a cache line, for trivially copyable simulation data
+template <typename T>
+class AlignedArray
+{
+  static_assert(std::is_trivially_copyable<T>::value, "AlignedArray only holds trivially copyable types");
+
+private:
+  T *ptr; // Start of storage
+  std::size_t len; // Number of elements in use
+  std::size_t cap; // Number of elements allocated
+
+  static T *allocate(std::size_t count)
+  {
+    if (count == 0)
+      return nullptr;
+    return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(CACHE_LINE_SIZE)));
+  }
+
+  static void release(T *p)
+  {
+    if (p)
+      ::operator delete(p, std::align_val_t(CACHE_LINE_SIZE));
+  }
+
+public:
+  AlignedArray(std::size_t count = 0) : ptr(allocate(count)), len(count), cap(count)
+  {
+    std::fill(ptr, ptr + len, T());
+  }
+
+  AlignedArray(const AlignedArray &other) : ptr(allocate(other.len)), len(other.len), cap(other.len)
+  {
+    std::copy(other.ptr, other.ptr + len, ptr);
+  }
+
+  AlignedArray(AlignedArray &&other) noexcept : ptr(other.ptr), len(other.len), cap(other.cap)
+  {
+    other.ptr = nullptr;
+    other.len = 0;
+    other.cap = 0;
+  }
+
+  AlignedArray &operator=(AlignedArray other) noexcept
+  {
+    std::swap(ptr, other.ptr);
+    std::swap(len, other.len);
+    std::swap(cap, other.cap);
+    return *this;
+  }
+
+  ~AlignedArray() { release(ptr); }
+
+  // Change the number of elements, existing values are kept and new ones are value initialized
+  void resize(std::size_t count)
+  {
+    if (count > cap)
+    {
+      T *next = allocate(count);
+      std::copy(ptr, ptr + len, next);
+      release(ptr);
+      ptr = next;
+      cap = count;
+    }
+    if (count > len)
+      std::fill(ptr + len, ptr + count, T());
+    len = count;
+  }
+
+  // Free all storage
+  void clear()
+  {
+    release(ptr);
+    ptr = nullptr;
+    len = 0;
+    cap = 0;
+  }
+
+  void fill(const T &value) { std::fill(ptr, ptr + len, value); }
+
+  T &operator[](std::size_t i) { return ptr[i]; }
+  const T &operator[](std::size_t i) const { return ptr[i]; }
+  T *data() { return ptr; }
+  const T *data() const { return ptr; }
+  T *begin() { return ptr; }
+  T *end() { return ptr + len; }
+  const T *begin() const { return ptr; }
+  const T *end() const { return ptr + len; }
+  std::size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+  std::size_t bytes() const { return cap * sizeof(T); }
+};
+
+#endif
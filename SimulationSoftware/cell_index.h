@@ -0,0 +1,70 @@
+#ifndef CELL_INDEX_H
+#define CELL_INDEX_H
+
+#include "aligned_array.h"
+#include "fitness_map.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+constexpr uint32_t NO_INDEX = 0xFFFFFFFF; // Index of a cell that isn't listed
+constexpr std::size_t DENSE_INDEX_CELLS = std::size_t(1) << 20; // Maps up to this size always get a table
+
+// Where each occupied cell sits in a list of occupied cells. Stored maps with no more cells than
+// organisms get a table over every cell (one read per lookup, costing less than the map itself).
+// Procedural or larger maps get a hash map over the listed cells only, so memory follows the
+// population instead of the map.
+class CellIndex
+{
+private:
+  bool dense;
+  AlignedArray<uint32_t> table; // Index of every cell when dense
+  std::unordered_map<uint32_t, uint32_t> listed; // Index of each listed cell otherwise
+
+public:
+  CellIndex() : dense(true) {}
+
+  // Empty the index and pick its storage for a map and population size
+  void reset(const FitnessMap &map, uint64_t organisms)
+  {
+    dense = map.storage != STORAGE_PROCEDURAL &&
+            map.cells() <= std::max<uint64_t>(organisms, DENSE_INDEX_CELLS);
+    listed.clear();
+    if (dense)
+    {
+      table = AlignedArray<uint32_t>(map.cells());
+      table.fill(NO_INDEX);
+    }
+    else
+    {
+      table = AlignedArray<uint32_t>();
+    }
+  }
+
+  uint32_t find(uint32_t cell) const
+  {
+    if (dense)
+      return table[cell];
+    auto it = listed.find(cell);
+    return (it == listed.end()) ? NO_INDEX : it->second;
+  }
+
+  void set(uint32_t cell, uint32_t index)
+  {
+    if (dense)
+      table[cell] = index;
+    else
+      listed[cell] = index;
+  }
+
+  void erase(uint32_t cell)
+  {
+    if (dense)
+      table[cell] = NO_INDEX;
+    else
+      listed.erase(cell);
+  }
+};
+
+#endif
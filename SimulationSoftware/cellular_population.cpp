@@ -0,0 +1,284 @@
+#include "cellular_population.h"
+#include "thread_count.h"
+#include "philox.h"
+#include "emp/math/Random.hpp"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+
+/*
+ * Constructs a CellularPopulation with every slot on one gene pair
+ * Arguments: lattice width, lattice height, mutation rate, starting x gene, starting y gene
+ * Returns: CellularPopulation
+ */
+CellularPopulation::CellularPopulation(int width, int height, double m, int xstart, int ystart) :
+  width(std::max(width, 1)),
+  height(std::max(height, 1)),
+  m(m),
+  fitness_map(std::max(DEFAULT_GENE_SIZE, xstart + 1), std::max(DEFAULT_GENE_SIZE, ystart + 1))
+{
+  n = this->width * this->height;
+  gen = 0; // Generation number, starts at 0
+  threads = 0;
+  tile_size = CELLULAR_TILE;
+  neighborhood = NEIGHBORHOOD_VON_NEUMANN;
+  boundary = BOUNDARY_CLAMP;
+
+  emp::Random rng;
+  setSeed(rng.GetSeed());
+
+  // Initialize every slot at start of current genetic map (fitness map starts as all 0s)
+  first_pop = true;
+  lattice1 = AlignedArray<Organism>(n);
+  lattice2 = AlignedArray<Organism>(n);
+  for (int i = 0; i < n; ++i)
+    lattice1[i].cell = fitness_map.toCell(xstart, ystart);
+  newInitPop();
+}
+
+/*
+ * Function that will simulate generations of the lattice
+ * Arguments: How many generations, flag for selection method, tournament size to be used, and flag for saving
+ * Returns: Nothing
+ */
+void CellularPopulation::evolve(int generations, char selection, int tournament_size, bool save_all, std::string save_dir)
+{
+  std::string file_start = save_dir.append("gen_"); // File path to save to, gen_#, # is determined later
+
+  std::string file;
+  if (save_all)
+  {
+    file = file_start + std::to_string(gen) + ".txt";
+    savePopulation(file);
+  }
+
+  for (int i = 0; i < generations; ++i)
+  {
+    // Next generation
+    ++gen;
+    nextGeneration(selection, tournament_size);
+
+    // Save current generation
+    if (save_all)
+    {
+      file = file_start + std::to_string(gen) + ".txt";
+      savePopulation(file);
+    }
+  }
+}
+
+/*
+ * Function to create the next generation, tile by tile. A slot whose neighborhood has no fitness
+ * under roulette keeps its organism.
+ * Arguments: flag for selection method, tournament size
+ * Returns: Nothing
+ */
+void CellularPopulation::nextGeneration(char selection, int tournament_size)
+{
+  const AlignedArray<Organism> &parents = first_pop ? lattice1 : lattice2;
+  AlignedArray<Organism> &children = first_pop ? lattice2 : lattice1;
+
+  // Memoized landscapes fill the tiles parents sit on now, so the parallel lookups are read only
+  if (fitness_map.memoize && fitness_map.storage == STORAGE_PROCEDURAL)
+    for (int i = 0; i < n; ++i)
+      fitness_map.memoizeCell(parents[i].cell);
+
+  bool roulette = (selection == 'r');
+  int t = (selection == 't') ? std::max(tournament_size, 1) : 7;
+  int tile = std::max(tile_size, 1);
+  int tiles_x = (width + tile - 1) / tile;
+  int tiles_y = (height + tile - 1) / tile;
+  int span = tile + 2; // Halo row length
+
+  // Neighborhood slots as offsets into the halo, the slot itself first
+  const int offsets[9] = {0, -span, span, -1, 1, -span - 1, -span + 1, span - 1, span + 1};
+  int k = (neighborhood == NEIGHBORHOOD_MOORE) ? 9 : 5;
+
+  #pragma omp parallel num_threads(threadCount(threads))
+  {
+    std::vector<uint32_t> halo_cells(std::size_t(span) * span);
+    std::vector<double> halo_fitness(std::size_t(span) * span);
+
+    #pragma omp for schedule(static)
+    for (int tile_index = 0; tile_index < tiles_x * tiles_y; ++tile_index)
+    {
+      int x0 = (tile_index % tiles_x) * tile;
+      int y0 = (tile_index / tiles_x) * tile;
+      int w = std::min(tile, width - x0);
+      int h = std::min(tile, height - y0);
+
+      // Copy the tile and its halo out of the old lattice, wrapping around the lattice edges
+      for (int hy = 0; hy < h + 2; ++hy)
+      {
+        int y = (y0 + hy - 1 + height) % height;
+        for (int hx = 0; hx < w + 2; ++hx)
+        {
+          int x = (x0 + hx - 1 + width) % width;
+          uint32_t cell = parents[std::size_t(y) * width + x].cell;
+          halo_cells[hy * span + hx] = cell;
+          halo_fitness[hy * span + hx] = fitness_map[cell];
+        }
+      }
+
+      for (int ly = 0; ly < h; ++ly)
+      {
+        for (int lx = 0; lx < w; ++lx)
+        {
+          int slot = (y0 + ly) * width + x0 + lx;
+          int center = (ly + 1) * span + lx + 1;
+          PhiloxStream slot_rng(seed, gen, slot);
+
+          int parent = center;
+          if (roulette)
+          {
+            double total = 0.0;
+            for (int j = 0; j < k; ++j)
+              total += halo_fitness[center + offsets[j]];
+            if (total > 0)
+            {
+              double spin = slot_rng.GetDouble() * total;
+              int j = 0;
+              while (j < k - 1 && (spin -= halo_fitness[center + offsets[j]]) >= 0)
+                ++j;
+              parent = center + offsets[j];
+            }
+          }
+          else
+          {
+            // Best of t picks from the neighborhood, ties go to the first picked
+            parent = center + offsets[slot_rng.GetInt(0, k)];
+            for (int j = 0; j < t - 1; ++j)
+            {
+              int pick = center + offsets[slot_rng.GetInt(0, k)];
+              if (halo_fitness[pick] > halo_fitness[parent])
+                parent = pick;
+            }
+          }
+
+          // Create child, check if there's a mutation
+          children[slot].cell = halo_cells[parent];
+          if (slot_rng.P(m))
+            children[slot].mutate(slot_rng.GetInt(0, NUM_DIRECTIONS), fitness_map, boundary);
+        }
+      }
+    }
+  }
+
+  // Change to use other lattice
+  first_pop = !first_pop;
+}
+
+/*
+ * Function to set a new initial population start (saves current lattice)
+ * Arguments: None
+ * Returns: None
+ */
+void CellularPopulation::newInitPop()
+{
+  init_lattice = first_pop ? lattice1 : lattice2;
+}
+
+/*
+ * Function to reset the lattice
+ * Arguments: None
+ * Returns: Nothing
+ */
+void CellularPopulation::reset()
+{
+  gen = 0;
+  first_pop = true;
+  lattice1 = init_lattice;
+}
+
+/*
+ * Function to seed the per slot streams
+ * Arguments: Seed value
+ * Returns: Nothing
+ */
+void CellularPopulation::setSeed(int seed)
+{
+  this->seed = uint64_t(seed);
+}
+
+/*
+ * Function to get the average fitness of the lattice
+ * Arguments: None
+ * Returns: Mean fitness
+ */
+double CellularPopulation::meanFitness() const
+{
+  const AlignedArray<Organism> &current = first_pop ? lattice1 : lattice2;
+  double sum = 0.0;
+  for (int i = 0; i < n; ++i)
+    sum += current[i].getFitness(fitness_map);
+  return sum / n;
+}
+
+/*
+ * Function to use a procedural landscape instead of a loaded fitness map, organisms keep their genes
+ * Arguments: landscape, width, height, flag to memoize tiles organisms have reached
+ * Returns: Nothing
+ */
+void CellularPopulation::useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize)
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.setLandscape(landscape, xlim, ylim, memoize))
+    remapOrganisms(old_xlim, old_layout);
+}
+
+/*
+ * Function to repack organism cells after the fitness map width or layout changed
+ * Arguments: Width and layout the cells were packed with
+ * Returns: Nothing
+ */
+void CellularPopulation::remapOrganisms(int old_xlim, CellLayout old_layout)
+{
+  auto remap = [this, old_xlim, old_layout](Organism &o)
+  {
+    o.cell = fitness_map.remapCell(o.cell, old_xlim, old_layout);
+  };
+
+  for (int i = 0; i < n; ++i)
+  {
+    remap(init_lattice[i]);
+    remap(lattice1[i]);
+    remap(lattice2[i]);
+  }
+}
+
+/*
+ * Function to save the lattice to file, slots in row order
+ * Arguments: Filepath/name to save to
+ * Returns: Nothing
+ */
+void CellularPopulation::savePopulation(std::string file)
+{
+  std::ofstream f(file);
+
+  f << "N " << n << std::endl;
+  f << "M " << m << std::endl;
+  f << "G " << gen << std::endl;
+
+  const AlignedArray<Organism> &current = first_pop ? lattice1 : lattice2;
+  for (int i = 0; i < n; ++i)
+    f << fitness_map.getX(current[i].cell) << " " << fitness_map.getY(current[i].cell) << " "
+      << current[i].getFitness(fitness_map) << std::endl;
+
+  f.close();
+}
+
+/*
+ * Function to load a fitness function from file (2D array)
+ * Arguments: Filepath/name to load from
+ * Returns: Nothing
+ */
+void CellularPopulation::loadFitnessFunction(std::string file)
+{
+  // Organism cells depend on the map width, so repack them after loading
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.load(file))
+    remapOrganisms(old_xlim, old_layout);
+}
@@ -0,0 +1,75 @@
+#ifndef CELLULAR_POPULATION_H
+#define CELLULAR_POPULATION_H
+
+#include "aligned_array.h"
+#include "evolution.h"
+#include "fitness_map.h"
+#include <cstdint>
+#include <string>
+
+constexpr int CELLULAR_TILE = 64; // Lattice slots per tile side, a tile and its halo stay in cache
+
+// Slots a lattice slot's parent can come from, always including the slot itself
+enum Neighborhood
+{
+  NEIGHBORHOOD_VON_NEUMANN = 0, // The slot and its 4 edge neighbors
+  NEIGHBORHOOD_MOORE = 1 // The slot and its 8 edge and corner neighbors
+};
+
+// Spatially structured population: one organism per slot of a width x height lattice that wraps
+// around, and each slot's child has a parent from that slot's neighborhood. Children go into a
+// second lattice, so every slot reads the old lattice and a generation can be split into tiles on
+// any number of threads without locks. Each tile copies itself and a 1 slot halo (cells and
+// fitness) into thread scratch before making its children. Each slot draws from its own Philox
+// stream keyed by seed, generation and slot, so results don't depend on the thread count.
+struct CellularPopulation
+{
+  int width; // Lattice slots per row
+  int height; // Lattice rows
+  int n; // Number of organisms, width * height
+  double m; // Mutation rate
+  int gen; // Current generation number
+
+  uint64_t seed; // Key for the per slot random streams
+  int threads; // OpenMP threads, 0 uses the OpenMP default
+  int tile_size; // Lattice slots per tile side
+
+  Neighborhood neighborhood;
+  BoundaryMode boundary; // Where mutations off the fitness map edge go (the lattice itself always wraps)
+
+  // Organism storage, slot (x, y) at y * width + x
+  bool first_pop; // Using lattice1 if true, else lattice2 is current
+  AlignedArray<Organism> init_lattice; // Initial lattice, used for resetting
+  AlignedArray<Organism> lattice1;
+  AlignedArray<Organism> lattice2;
+  FitnessMap fitness_map;
+
+  // Population constructor
+  CellularPopulation(int width = 100,
+                     int height = 100,
+                     double m = 0.01,
+                     int xstart = 0,
+                     int ystart = 0);
+
+  // Main simulation, 'r' is roulette over the neighborhood, otherwise a tournament within it
+  void evolve(int generations = 100,
+              char selection = 't',
+              int tournament_size = 7,
+              bool save_all = false,
+              std::string save_dir = "./TestData");
+  void nextGeneration(char selection, int tournament_size);
+  void newInitPop();
+  void reset();
+  void setSeed(int seed);
+  double meanFitness() const;
+
+  // Fitness map changes, keeps organisms on the same genes
+  void useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize = false);
+  void remapOrganisms(int old_xlim, CellLayout old_layout);
+
+  // File IO, slots in row order in the Population format
+  void savePopulation(std::string file);
+  void loadFitnessFunction(std::string file);
+};
+
+#endif
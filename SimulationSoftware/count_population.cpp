@@ -0,0 +1,440 @@
+#include "count_population.h"
+#include "sampling.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/*
+ * Constructs a Population stored as counts per cell
+ * Arguments: size of population, mutation rate, starting x gene, starting y gene
+ * Returns: CountPopulation
+ */
+CountPopulation::CountPopulation(uint64_t n, double m, int xstart, int ystart) :
+  n(n),
+  m(m),
+  fitness_map(std::max(DEFAULT_GENE_SIZE, xstart + 1), std::max(DEFAULT_GENE_SIZE, ystart + 1))
+{
+  gen = 0; // Generation number, starts at 0
+
+  // Initialize population at start of current genetic map (fitness map starts as all 0s)
+  setCells({std::make_pair(fitness_map.toCell(xstart, ystart), n)});
+  newInitPop();
+}
+
+/*
+ * Function that will simulate generations of a population
+ * Arguments: How many generations, flag for selection method, tournament size to be used, and flag for saving
+ * Returns: Nothing
+ */
+void CountPopulation::evolve(int generations, char selection, int tournament_size, bool save_all, std::string save_dir)
+{
+  std::string file_start = save_dir.append("gen_"); // File path to save to, gen_#, # is determined later
+
+  // Ensure that there is a population
+  if (n == 0)
+  {
+    std::cout << "Cannot evolve with an empty population" << std::endl;
+    return;
+  }
+
+  std::string file;
+  if (save_all)
+  {
+    file = file_start + std::to_string(gen) + ".txt";
+    savePopulation(file);
+  }
+
+  for (int i = 0; i < generations; ++i)
+  {
+    // Next generation
+    ++gen;
+
+    // Memoized landscapes fill the tiles of occupied cells before they are looked up
+    if (fitness_map.memoize && fitness_map.storage == STORAGE_PROCEDURAL)
+      for (uint32_t cell : occupied)
+        fitness_map.memoizeCell(cell);
+
+    // Draw how many children each occupied cell has
+    switch(selection)
+    {
+    case 't':
+      selectionTournament(tournament_size);
+      break;
+    case 'r':
+      selectionRoulette();
+      break;
+    case 'u':
+      selectionUniversal();
+      break;
+    default:
+      selectionTournament(7);
+    }
+
+    // Apply mutations and move children into place
+    mutateOffspring();
+
+    // Save current generation
+    if (save_all)
+    {
+      file = file_start + std::to_string(gen) + ".txt";
+      savePopulation(file);
+    }
+  }
+}
+
+/*
+ * Function to set a new initial population start (saves current population)
+ * Arguments: None
+ * Returns: None
+ */
+void CountPopulation::newInitPop()
+{
+  init_cells.clear();
+  for (std::size_t i = 0; i < occupied.size(); ++i)
+    init_cells.push_back(std::make_pair(occupied[i], counts[i]));
+}
+
+/*
+ * Function to reset a population
+ * Arguments: None
+ * Returns: Nothing
+ */
+void CountPopulation::reset()
+{
+  gen = 0;
+  setCells(init_cells);
+}
+
+/*
+ * Function to draw children per cell via tournament selection. The winner of a tournament of
+ * size t has fitness level f with probability P(fit <= f)^t - P(fit < f)^t, and ties go to the
+ * first organism drawn, so within a level each cell wins in proportion to its count.
+ * Arguments: Tournament size
+ * Returns: Nothing
+ */
+void CountPopulation::selectionTournament(int t)
+{
+  std::size_t k = occupied.size();
+  t = std::max(t, 1);
+
+  // Order occupied cells by fitness so equal fitness levels are adjacent
+  std::vector<std::size_t> order(k);
+  for (std::size_t i = 0; i < k; ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(),
+            [this](std::size_t a, std::size_t b) { return fitness_map[occupied[a]] < fitness_map[occupied[b]]; });
+
+  // Chance of each cell producing a tournament winner
+  weights.assign(k, 0.0);
+  uint64_t below = 0; // Organisms on a lower fitness level
+  for (std::size_t start = 0; start < k;)
+  {
+    double level = fitness_map[occupied[order[start]]];
+    std::size_t end = start;
+    uint64_t level_count = 0;
+    while (end < k && fitness_map[occupied[order[end]]] == level)
+    {
+      level_count += counts[order[end]];
+      ++end;
+    }
+
+    double win = std::pow(double(below + level_count) / n, t) - std::pow(double(below) / n, t);
+    for (std::size_t j = start; j < end; ++j)
+      weights[order[j]] = win * counts[order[j]] / level_count;
+
+    below += level_count;
+    start = end;
+  }
+
+  offspring.resize(k);
+  sampleMultinomial(rng, n, weights.data(), k, offspring.data());
+}
+
+/*
+ * Function to draw children per cell via roulette selection
+ * Arguments: None
+ * Returns: Nothing
+ */
+void CountPopulation::selectionRoulette()
+{
+  std::size_t k = occupied.size();
+  buildWeights();
+
+  offspring.resize(k);
+  sampleMultinomial(rng, n, weights.data(), k, offspring.data());
+}
+
+/*
+ * Function to give children per cell via stochastic universal sampling. n pointers spaced
+ * total / n apart from one random offset, so a cell gets the pointers landing on its stretch of
+ * the wheel: the floor or ceiling of its expected children.
+ * Arguments: None
+ * Returns: Nothing
+ */
+void CountPopulation::selectionUniversal()
+{
+  std::size_t k = occupied.size();
+  double total = buildWeights();
+  double spacing = total / n;
+  double offset = rng.GetDouble() * spacing;
+
+  // Pointers before the end of each cell's stretch, the last cell with weight takes the rest
+  std::size_t last = k - 1;
+  while (last > 0 && weights[last] == 0)
+    --last;
+
+  offspring.resize(k);
+  double end = 0.0;
+  uint64_t reached = 0;
+  for (std::size_t i = 0; i < k; ++i)
+  {
+    end += weights[i];
+    uint64_t before = n;
+    if (i < last)
+      before = std::min(n, uint64_t(std::max(0.0, std::ceil((end - offset) / spacing))));
+    before = std::max(before, reached);
+    offspring[i] = before - reached;
+    reached = before;
+  }
+}
+
+/*
+ * Function to weight each occupied cell by its count times its fitness
+ * Arguments: None
+ * Returns: Total weight
+ */
+double CountPopulation::buildWeights()
+{
+  std::size_t k = occupied.size();
+  weights.resize(k);
+  double total = 0.0;
+  for (std::size_t i = 0; i < k; ++i)
+  {
+    weights[i] = counts[i] * fitness_map[occupied[i]];
+    total += weights[i];
+  }
+
+  // Ensure population isn't dead
+  if (total == 0)
+  {
+    std::cout << "Population is dead, can't evolve!" << std::endl;
+    exit(1);
+  }
+  return total;
+}
+
+/*
+ * Function to mutate children and move them into the next generation. Each cell loses a
+ * binomial number of mutants, which split evenly at random over the four directions.
+ * Arguments: None
+ * Returns: Nothing
+ */
+void CountPopulation::mutateOffspring()
+{
+  const double directions[NUM_DIRECTIONS] = {1.0, 1.0, 1.0, 1.0};
+  uint64_t moved[NUM_DIRECTIONS];
+
+  next_occupied.clear();
+  next_counts.clear();
+  for (std::size_t i = 0; i < occupied.size(); ++i)
+  {
+    uint32_t cell = occupied[i];
+    uint64_t mutants = sampleBinomial(rng, offspring[i], m);
+    addCount(cell, offspring[i] - mutants);
+
+    if (mutants > 0)
+    {
+      sampleMultinomial(rng, mutants, directions, NUM_DIRECTIONS, moved);
+      for (int dir = 0; dir < NUM_DIRECTIONS; ++dir)
+        addCount(fitness_map.neighbor(cell, dir), moved[dir]);
+    }
+  }
+
+  // Empty the index and swap in the new generation
+  for (uint32_t cell : next_occupied)
+    next_index.erase(cell);
+  std::swap(counts, next_counts);
+  std::swap(occupied, next_occupied);
+}
+
+/*
+ * Function to add organisms to a cell of the next generation
+ * Arguments: cell, number of organisms
+ * Returns: Nothing
+ */
+void CountPopulation::addCount(uint32_t cell, uint64_t count)
+{
+  if (count == 0)
+    return;
+
+  uint32_t i = next_index.find(cell);
+  if (i == NO_INDEX)
+  {
+    i = next_occupied.size();
+    next_index.set(cell, i);
+    next_occupied.push_back(cell);
+    next_counts.push_back(0);
+  }
+  next_counts[i] += count;
+}
+
+/*
+ * Function to change how the fitness map packs cells (Morton keeps nearby genes in nearby memory),
+ * organisms keep their genes
+ * Arguments: cell layout
+ * Returns: Nothing
+ */
+void CountPopulation::setCellLayout(CellLayout layout)
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  fitness_map.setLayout(layout);
+  if (fitness_map.layout != old_layout)
+    remapCounts(old_xlim, old_layout);
+}
+
+/*
+ * Function to repack counts after the fitness map width changed
+ * Arguments: Width and layout the cells were packed with
+ * Returns: Nothing
+ */
+void CountPopulation::remapCounts(int old_xlim, CellLayout old_layout)
+{
+  // Several old cells can land on one new cell when the map shrinks, setCells merges them
+  std::vector<std::pair<uint32_t, uint64_t>> current;
+  for (std::size_t i = 0; i < occupied.size(); ++i)
+    current.push_back(std::make_pair(fitness_map.remapCell(occupied[i], old_xlim, old_layout), counts[i]));
+  std::sort(current.begin(), current.end());
+  setCells(current);
+
+  // Initial population keeps its own list, merged the same way
+  for (auto &init : init_cells)
+    init.first = fitness_map.remapCell(init.first, old_xlim, old_layout);
+  std::sort(init_cells.begin(), init_cells.end());
+  std::vector<std::pair<uint32_t, uint64_t>> merged;
+  for (auto &init : init_cells)
+  {
+    if (!merged.empty() && merged.back().first == init.first)
+      merged.back().second += init.second;
+    else
+      merged.push_back(init);
+  }
+  init_cells = merged;
+}
+
+/*
+ * Function to replace the population with organisms on the given cells, cells may repeat and are
+ * listed in the order they first appear
+ * Arguments: (cell, count) pairs
+ * Returns: Nothing
+ */
+void CountPopulation::setCells(const std::vector<std::pair<uint32_t, uint64_t>> &cells)
+{
+  n = 0;
+  for (auto &c : cells)
+    n += c.second;
+
+  // The index is sized for the current map, so it is picked again whenever cells are replaced
+  next_index.reset(fitness_map, n);
+  next_occupied.clear();
+  next_counts.clear();
+  for (auto &c : cells)
+    addCount(c.first, c.second);
+
+  for (uint32_t cell : next_occupied)
+    next_index.erase(cell);
+  std::swap(counts, next_counts);
+  std::swap(occupied, next_occupied);
+}
+
+/*
+ * Function to save a Population to file, one line per organism like Population::savePopulation
+ * Arguments: Filepath/name to save to
+ * Returns: Nothing
+ */
+void CountPopulation::savePopulation(std::string file)
+{
+  std::ofstream f(file);
+
+  f << "N " << n << std::endl;
+  f << "M " << m << std::endl;
+  f << "G " << gen << std::endl;
+
+  std::vector<std::pair<uint32_t, uint64_t>> cells;
+  for (std::size_t i = 0; i < occupied.size(); ++i)
+    cells.push_back(std::make_pair(occupied[i], counts[i]));
+  std::sort(cells.begin(), cells.end());
+  for (auto &c : cells)
+    for (uint64_t i = 0; i < c.second; ++i)
+      f << fitness_map.getX(c.first) << " " << fitness_map.getY(c.first) << " " << fitness_map[c.first] << std::endl;
+
+  f.close();
+}
+
+/*
+ * Function to load a Population from file
+ * Arguments: Filepath/name to load from
+ * Returns: Nothing
+ */
+void CountPopulation::loadPopulation(std::string file)
+{
+  std::ifstream f(file);
+
+  char temp;
+  f >> temp >> n;
+  f >> temp >> m;
+  f >> temp >> gen;
+
+  // Fitness is looked up from the map, the saved value is skipped
+  std::vector<std::pair<uint32_t, uint64_t>> cells;
+  int x, y;
+  double fit;
+  for (uint64_t i = 0; i < n; ++i)
+  {
+    f >> x >> y >> fit;
+    cells.push_back(std::make_pair(fitness_map.toCell(std::min(x, fitness_map.xlim - 1), std::min(y, fitness_map.ylim - 1)), 1));
+  }
+  std::sort(cells.begin(), cells.end());
+  setCells(cells);
+
+  f.close();
+}
+
+/*
+ * Function to load a fitness function from file (2D array)
+ * Arguments: Filepath/name to load from
+ * Returns: Nothing
+ */
+void CountPopulation::loadFitnessFunction(std::string file)
+{
+  // Cells depend on the map width, so repack counts after loading
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.load(file))
+    remapCounts(old_xlim, old_layout);
+}
+
+/*
+ * Function to use a procedural landscape instead of a loaded fitness map, organisms keep their genes
+ * Arguments: landscape, width, height, flag to memoize tiles organisms have reached
+ * Returns: Nothing
+ */
+void CountPopulation::useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize)
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.setLandscape(landscape, xlim, ylim, memoize))
+    remapCounts(old_xlim, old_layout);
+}
+
+/*
+ * Function to display the fitness map matrix
+ * Arguments: None
+ * Returns: Nothing
+ */
+void CountPopulation::displayFitnessFunction()
+{
+  fitness_map.display();
+}
@@ -0,0 +1,77 @@
+#ifndef COUNT_POPULATION_H
+#define COUNT_POPULATION_H
+
+#include "emp/math/Random.hpp"
+#include "cell_index.h"
+#include "fitness_map.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Population stored as the number of organisms on each fitness map cell. Organisms on the same
+// cell are identical, so a generation costs O(occupied cells) no matter how large n is. Only
+// occupied cells are stored, so memory doesn't grow with the map either.
+struct CountPopulation
+{
+  uint64_t n; // Number of organisms in population
+  double m; // Mutation rate
+  int gen; // Current generation number
+
+  // Random number generator
+  emp::Random rng;
+
+  // Occupancy storage
+  FitnessMap fitness_map;
+  std::vector<uint32_t> occupied; // Cells with organisms on them
+  std::vector<uint64_t> counts; // Organisms on each occupied cell, indexed like occupied
+  std::vector<std::pair<uint32_t, uint64_t>> init_cells; // Initial (cell, count) pairs, used for resetting
+
+  // Per generation scratch space, indexed like occupied
+  std::vector<double> weights;
+  std::vector<uint64_t> offspring;
+  std::vector<uint32_t> next_occupied;
+  std::vector<uint64_t> next_counts; // Indexed like next_occupied
+  CellIndex next_index; // Where each cell is in next_occupied, empty between generations
+
+  // Population constructor
+  CountPopulation(uint64_t n = 10000,
+                  double m = 0.01,
+                  int xstart = 0,
+                  int ystart = 0);
+
+  // Main simulation
+  void evolve(int generations = 100,
+              char selection = 't',
+              int tournament_size = 7,
+              bool save_all = false,
+              std::string save_dir = "./TestData");
+  void newInitPop();
+  void reset();
+
+  // Parent selection methods, fill offspring with children per occupied cell
+  void selectionTournament(int t);
+  void selectionRoulette();
+  void selectionUniversal();
+  double buildWeights();
+
+  // Moves offspring (with mutations) into the next generation's counts
+  void mutateOffspring();
+  void addCount(uint32_t cell, uint64_t count);
+
+  // Fitness map changes, keeps organisms on the same genes
+  void useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize = false);
+  void setCellLayout(CellLayout layout);
+  void remapCounts(int old_xlim, CellLayout old_layout);
+  void setCells(const std::vector<std::pair<uint32_t, uint64_t>> &cells);
+
+  // File IO
+  void savePopulation(std::string file);
+  void loadPopulation(std::string file);
+  void loadFitnessFunction(std::string file);
+
+  // Display functions
+  void displayFitnessFunction();
+};
+
+#endif
@@ -0,0 +1,355 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "alias_table.h"
+#include "fitness_map.h"
+#include "sampling.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Generation loop built from compile time policies. Each combination of selection, mutation,
+// boundary and fitness storage is its own instantiation, so the per child loop has no switches
+// left in it. Population::evolve keeps its char based interface and picks the instantiation.
+
+// Boundary policies, cell reached by a mutation in a direction
+
+struct ClampBoundary
+{
+  static uint32_t step(const FitnessMap &map, uint32_t cell, int dir) { return map.neighbor(cell, dir); }
+};
+
+struct WrapBoundary
+{
+  static uint32_t step(const FitnessMap &map, uint32_t cell, int dir) { return map.wrapNeighbor(cell, dir); }
+};
+
+struct ReflectBoundary
+{
+  static uint32_t step(const FitnessMap &map, uint32_t cell, int dir) { return map.reflectNeighbor(cell, dir); }
+};
+
+// Fitness storage policies, what tournaments compare
+
+// Fitness values straight from the map
+struct ValueFitness
+{
+  using type = double;
+  static type get(const FitnessMap &map, uint32_t cell) { return map[cell]; }
+};
+
+// Fitness levels (2 bytes per cell instead of 8), same order as the values. Needs updateLevels().
+struct LevelFitness
+{
+  using type = uint16_t;
+  static type get(const FitnessMap &map, uint32_t cell) { return map.levels[cell]; }
+};
+
+// Palette map levels (1 byte per cell), for palettes of at most MAX_BYTE_LEVELS values
+struct ByteLevelFitness
+{
+  using type = uint8_t;
+  static type get(const FitnessMap &map, uint32_t cell) { return map.byte_levels[cell]; }
+};
+
+// Mutation policies, decide child by child whether it mutates
+
+// Coin flip per child
+struct PerChildMutation
+{
+  double m;
+
+  template <typename RNG>
+  void begin(RNG &, double rate) { m = rate; }
+
+  template <typename RNG>
+  bool next(RNG &rng) { return rng.P(m); }
+};
+
+// Count down a geometric gap to the next mutated child, one draw per mutation instead of per child
+struct GeometricMutation
+{
+  double log_keep; // log(1 - m)
+  uint64_t wait; // Children left before the next mutation
+
+  template <typename RNG>
+  void begin(RNG &rng, double rate)
+  {
+    log_keep = std::log1p(-std::min(rate, 1.0));
+    wait = sampleGeometric(rng, log_keep);
+  }
+
+  template <typename RNG>
+  bool next(RNG &rng)
+  {
+    if (wait > 0)
+    {
+      --wait;
+      return false;
+    }
+    wait = sampleGeometric(rng, log_keep);
+    return true;
+  }
+};
+
+// Selection policies, pick the cell a child starts from
+
+// Best of t uniform picks, ties go to the first picked
+template <typename Storage>
+struct TournamentSelection
+{
+  const FitnessMap &map;
+  int t;
+
+  template <typename RNG, typename Org>
+  uint32_t pick(RNG &rng, const Org *parents, int n) const
+  {
+    int max_parent = rng.GetInt(0, n);
+    typename Storage::type max_fit = Storage::get(map, parents[max_parent].cell);
+    for (int j = 0; j < t - 1; ++j)
+    {
+      int parent = rng.GetInt(0, n);
+      typename Storage::type fit = Storage::get(map, parents[parent].cell);
+      if (fit > max_fit)
+      {
+        max_parent = parent;
+        max_fit = fit;
+      }
+    }
+    return parents[max_parent].cell;
+  }
+
+  // Steady state replacement, tournaments need no bookkeeping
+  bool replace(uint32_t, uint32_t) const { return true; }
+};
+
+// Spin of a prebuilt alias wheel, slots are organisms or (if cells is set) occupied cells
+struct RouletteSelection
+{
+  const AliasTable &table;
+  const uint32_t *cells;
+
+  template <typename RNG, typename Org>
+  uint32_t pick(RNG &rng, const Org *parents, int) const
+  {
+    uint32_t slot = table.sample(rng);
+    return cells ? cells[slot] : parents[slot].cell;
+  }
+};
+
+// Stochastic universal sampling: n evenly spaced pointers over the cumulative weights, placed by one
+// random offset. Picks walk the weights in order, so one policy makes one generation's n picks in
+// a single pass and keeps its place between picks. Slots are organisms or (if cells is set) cells.
+struct UniversalSelection
+{
+  const double *weights;
+  const uint32_t *cells;
+  std::size_t last; // Last slot with weight, rounding can't carry a pointer past it
+  double spacing; // Total weight / n
+  double offset; // First pointer, in [0, spacing)
+  mutable std::size_t slot; // Slot holding the current pointer
+  mutable double end; // Weight of the slots up to and including slot
+  mutable uint64_t picked; // Pointers used so far
+
+  template <typename RNG, typename Org>
+  uint32_t pick(RNG &, const Org *parents, int) const
+  {
+    double pointer = offset + picked++ * spacing;
+    while (end <= pointer && slot < last)
+      end += weights[++slot];
+    return cells ? cells[slot] : parents[slot].cell;
+  }
+};
+
+// Fitness proportional pick by stochastic acceptance: a uniform organism is kept with probability
+// fitness / max_fit. Needs no wheel, so it works on a population that changes between picks.
+struct AcceptanceSelection
+{
+  const FitnessMap &map;
+  double max_fit; // At least the fitness of every organism
+  int alive; // Organisms with fitness above 0, there must be one for a pick to end
+
+  template <typename RNG, typename Org>
+  uint32_t pick(RNG &rng, const Org *parents, int n) const
+  {
+    while (true)
+    {
+      uint32_t cell = parents[rng.GetInt(0, n)].cell;
+      if (rng.GetDouble() * max_fit < map[cell])
+        return cell;
+    }
+  }
+
+  // Steady state replacement, returns false once no organism can be picked
+  bool replace(uint32_t old_cell, uint32_t new_cell)
+  {
+    double fit = map[new_cell];
+    max_fit = std::max(max_fit, fit);
+    alive += (fit > 0) - (map[old_cell] > 0);
+    return alive > 0;
+  }
+};
+
+constexpr double DEFAULT_RANK_PRESSURE = 1.5; // Expected children of the fittest organism under rank selection
+constexpr double DEFAULT_TRUNCATION_SHARE = 0.5; // Share of the population truncation selection keeps
+
+// Rank policies, where in the fitness ranking a parent comes from. Positions run over [0, 1) from
+// the least fit organism: share(x) is the chance a pick is in the lowest x of the population and
+// position(u) inverts it, turning a uniform draw into a pick.
+
+// Best of t uniform picks
+struct TournamentRank
+{
+  double t;
+  double inv_t; // 1 / t
+
+  double share(double x) const { return std::pow(x, t); }
+  double position(double u) const { return std::pow(u, inv_t); }
+};
+
+// Linear ranking, the fittest organism expects pressure children and the least fit 2 - pressure
+// (pressure in [1, 2])
+struct LinearRank
+{
+  double pressure;
+
+  double share(double x) const { return (2 - pressure) * x + (pressure - 1) * x * x; }
+  double position(double u) const
+  {
+    // Root of share(x) = u, in the form that stays accurate as pressure goes to 1
+    double a = 2 - pressure;
+    return 2 * u / (a + std::sqrt(a * a + 4 * (pressure - 1) * u));
+  }
+};
+
+// Truncation, parents are uniform over the fittest share of the population (share in (0, 1])
+struct TruncationRank
+{
+  double kept;
+
+  double share(double x) const { return std::max(0.0, x - (1 - kept)) / kept; }
+  double position(double u) const { return 1 - kept + kept * u; }
+};
+
+/*
+ * Function to make one generation of children from the given policies
+ * Arguments: fitness map, current population, next population, population size, mutation rate,
+ *            selection policy, random number generator
+ * Returns: Nothing
+ */
+template <typename Boundary, typename Mutation, typename Selection, typename RNG, typename Org>
+void runGeneration(const FitnessMap &map, const Org *parents, Org *children, int n, double m,
+                   const Selection &selection, RNG &rng)
+{
+  Mutation mutation;
+  mutation.begin(rng, m);
+  for (int i = 0; i < n; ++i)
+  {
+    uint32_t cell = selection.pick(rng, parents, n);
+    if (mutation.next(rng))
+      cell = Boundary::step(map, cell, rng.GetInt(0, 4));
+    children[i].cell = cell;
+  }
+}
+
+/*
+ * Function to pick the mutation and boundary policies at runtime and run a generation
+ * Arguments: fitness map, current population, next population, population size, mutation rate,
+ *            selection policy, random number generator, geometric mutation flag, boundary mode
+ * Returns: Nothing
+ */
+template <typename Selection, typename RNG, typename Org>
+void dispatchGeneration(const FitnessMap &map, const Org *parents, Org *children, int n, double m,
+                        const Selection &selection, RNG &rng, bool geometric, BoundaryMode boundary)
+{
+  auto run = [&](auto boundary_policy)
+  {
+    using Boundary = decltype(boundary_policy);
+    if (geometric)
+      runGeneration<Boundary, GeometricMutation>(map, parents, children, n, m, selection, rng);
+    else
+      runGeneration<Boundary, PerChildMutation>(map, parents, children, n, m, selection, rng);
+  };
+
+  switch(boundary)
+  {
+  case BOUNDARY_WRAP:
+    run(WrapBoundary());
+    break;
+  case BOUNDARY_REFLECT:
+    run(ReflectBoundary());
+    break;
+  default:
+    run(ClampBoundary());
+  }
+}
+
+/*
+ * Function to make one generation of steady state births from the given policies. Children are
+ * made a batch at a time into scratch, then each replaces a uniformly random organism, so the
+ * population is only stored once.
+ * Arguments: fitness map, population, scratch (batch organisms), population size, batch size,
+ *            mutation rate, selection policy, random number generator
+ * Returns: False if selection can no longer pick a parent (population is dead)
+ */
+template <typename Boundary, typename Mutation, typename Selection, typename RNG, typename Org>
+bool runSteadyState(const FitnessMap &map, Org *population, Org *scratch, int n, int batch, double m,
+                    Selection &selection, RNG &rng)
+{
+  Mutation mutation;
+  mutation.begin(rng, m);
+  for (int born = 0; born < n; born += batch)
+  {
+    // Every parent of a batch is picked before any of its children are placed
+    int count = std::min(batch, n - born);
+    for (int i = 0; i < count; ++i)
+    {
+      uint32_t cell = selection.pick(rng, population, n);
+      if (mutation.next(rng))
+        cell = Boundary::step(map, cell, rng.GetInt(0, 4));
+      scratch[i].cell = cell;
+    }
+
+    bool alive = true;
+    for (int i = 0; i < count; ++i)
+    {
+      int victim = rng.GetInt(0, n);
+      alive = selection.replace(population[victim].cell, scratch[i].cell);
+      population[victim] = scratch[i];
+    }
+    if (!alive)
+      return false;
+  }
+  return true;
+}
+
+/*
+ * Function to pick the mutation and boundary policies at runtime and run a steady state generation
+ * Arguments: fitness map, population, scratch, population size, batch size, mutation rate,
+ *            selection policy, random number generator, geometric mutation flag, boundary mode
+ * Returns: False if the population died
+ */
+template <typename Selection, typename RNG, typename Org>
+bool dispatchSteadyState(const FitnessMap &map, Org *population, Org *scratch, int n, int batch, double m,
+                         Selection &selection, RNG &rng, bool geometric, BoundaryMode boundary)
+{
+  auto run = [&](auto boundary_policy)
+  {
+    using Boundary = decltype(boundary_policy);
+    if (geometric)
+      return runSteadyState<Boundary, GeometricMutation>(map, population, scratch, n, batch, m, selection, rng);
+    return runSteadyState<Boundary, PerChildMutation>(map, population, scratch, n, batch, m, selection, rng);
+  };
+
+  switch(boundary)
+  {
+  case BOUNDARY_WRAP:
+    return run(WrapBoundary());
+  case BOUNDARY_REFLECT:
+    return run(ReflectBoundary());
+  default:
+    return run(ClampBoundary());
+  }
+}
+
+#endif
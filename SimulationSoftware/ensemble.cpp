@@ -0,0 +1,391 @@
+#include "ensemble.h"
+#include "thread_count.h"
+#include "philox.h"
+#include "emp/math/Random.hpp"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+/*
+ * Constructs an Ensemble of identical starting populations
+ * Arguments: number of replicates, size of each population, mutation rate, starting x gene, starting y gene
+ * Returns: Ensemble
+ */
+Ensemble::Ensemble(int replicates, int n, double m, int xstart, int ystart) :
+  replicates(replicates),
+  n(n),
+  m(m),
+  init_pop(std::size_t(n) * replicates),
+  pop1(std::size_t(n) * replicates),
+  pop2(std::size_t(n) * replicates),
+  fitness_map(std::max(DEFAULT_GENE_SIZE, xstart + 1), std::max(DEFAULT_GENE_SIZE, ystart + 1))
+{
+  gen = 0; // Generation number, starts at 0
+  parallel = false;
+  threads = 0;
+  roulette_by_cell = false;
+
+  // Replicate r uses seed + r
+  emp::Random rng;
+  setSeed(rng.GetSeed());
+
+  // Initialize every replicate at start of current genetic map (fitness map starts as all 0s)
+  first_pop = true;
+  pop1.fill(fitness_map.toCell(xstart, ystart));
+  newInitPop();
+}
+
+/*
+ * Function that will simulate generations of every replicate
+ * Arguments: How many generations, flag for selection method, tournament size to be used, and flag for saving
+ * Returns: Nothing
+ */
+void Ensemble::evolve(int generations, char selection, int tournament_size, bool save_all, std::string save_dir)
+{
+  // Ensure that there is a population
+  if (n == 0 || replicates == 0)
+  {
+    std::cout << "Cannot evolve with an empty population" << std::endl;
+    return;
+  }
+
+  // Files are rep_#_gen_#.txt, one per replicate and generation
+  auto saveAll = [this, &save_dir]()
+  {
+    for (int r = 0; r < replicates; ++r)
+      savePopulation(r, save_dir + "rep_" + std::to_string(r) + "_gen_" + std::to_string(gen) + ".txt");
+  };
+
+  if (save_all)
+    saveAll();
+
+  bool roulette = (selection == 'r');
+  int t = (selection == 't') ? tournament_size : 7;
+  for (int i = 0; i < generations; ++i)
+  {
+    // Next generation
+    ++gen;
+    nextGeneration(roulette, std::max(t, 1));
+
+    // Save current generation
+    if (save_all)
+      saveAll();
+  }
+}
+
+/*
+ * Function to create the next generation of every replicate. Each child index is handled for all
+ * replicates at once: one Philox block per lane supplies the parent picks, mutation coin and
+ * direction, then each step of selection runs as a loop over replicates.
+ * Arguments: flag for roulette selection (else tournament), tournament size
+ * Returns: Nothing
+ */
+void Ensemble::nextGeneration(bool roulette, int t)
+{
+  const AlignedArray<uint32_t> &parents = first_pop ? pop1 : pop2;
+  AlignedArray<uint32_t> &children = first_pop ? pop2 : pop1;
+
+  const int R = replicates;
+  std::size_t total = std::size_t(n) * R;
+
+  // Memoized landscapes fill the tiles parents sit on before the parallel lookups
+  if (fitness_map.memoize && fitness_map.storage == STORAGE_PROCEDURAL)
+    for (std::size_t i = 0; i < total; ++i)
+      fitness_map.memoizeCell(parents[i]);
+
+  // Tournaments compare fitness many times per parent, so look each one up once (roulette wheels
+  // built by organism use it too)
+  parent_fitness.resize(total);
+  #pragma omp parallel for simd num_threads(parallel ? threadCount(threads) : 1) schedule(static)
+  for (std::size_t i = 0; i < total; ++i)
+    parent_fitness[i] = fitness_map[parents[i]];
+
+  if (roulette)
+    buildRouletteTables();
+
+  // Random words each child needs per lane: picks, then mutation coin and direction
+  int picks = roulette ? 2 : t;
+  int rows = (picks + 2 + 3) / 4 * 4;
+  uint64_t mutate_below = uint64_t(std::min(std::max(m, 0.0), 1.0) * 4294967296.0);
+
+  #pragma omp parallel num_threads(parallel ? threadCount(threads) : 1)
+  {
+    AlignedArray<uint32_t> words(std::size_t(rows) * R);
+    AlignedArray<uint32_t> best(R);
+    AlignedArray<double> best_fit(R);
+
+    #pragma omp for schedule(static)
+    for (int i = 0; i < n; ++i)
+    {
+      // Row w holds word w of every lane, keyed by replicate seed, child index and generation
+      for (int b = 0; b < rows / 4; ++b)
+      {
+        uint32_t *w = &words[std::size_t(4 * b) * R];
+        const uint32_t *key_lo = &keys[0];
+        const uint32_t *key_hi = &keys[R];
+        #pragma omp simd
+        for (int r = 0; r < R; ++r)
+        {
+          uint32_t c0 = b, c1 = i, c2 = gen, c3 = 0;
+          philoxRounds(key_lo[r], key_hi[r], c0, c1, c2, c3);
+          w[r] = c0;
+          w[R + r] = c1;
+          w[2 * R + r] = c2;
+          w[3 * R + r] = c3;
+        }
+      }
+
+      if (roulette)
+      {
+        // Spin each replicate's wheel with a 53 bit double, slots become parent cells
+        for (int r = 0; r < R; ++r)
+        {
+          uint64_t hi = words[r] >> 5;
+          uint64_t lo = words[R + r] >> 6;
+          uint32_t slot = roulette_tables[r].pick((hi * 67108864.0 + lo) * (1.0 / 9007199254740992.0));
+          best[r] = roulette_by_cell ? roulette_cells[r][slot] : parents[std::size_t(slot) * R + r];
+        }
+      }
+      else
+      {
+        // Tournament as a masked max across lanes, first pick wins ties
+        #pragma omp simd
+        for (int r = 0; r < R; ++r)
+        {
+          uint32_t parent = uint32_t((uint64_t(words[r]) * n) >> 32);
+          best[r] = parent;
+          best_fit[r] = parent_fitness[std::size_t(parent) * R + r];
+        }
+        for (int k = 1; k < t; ++k)
+        {
+          const uint32_t *w = &words[std::size_t(k) * R];
+          #pragma omp simd
+          for (int r = 0; r < R; ++r)
+          {
+            uint32_t parent = uint32_t((uint64_t(w[r]) * n) >> 32);
+            double fit = parent_fitness[std::size_t(parent) * R + r];
+            bool greater = fit > best_fit[r];
+            best[r] = greater ? parent : best[r];
+            best_fit[r] = greater ? fit : best_fit[r];
+          }
+        }
+
+        // Winners become parent cells
+        #pragma omp simd
+        for (int r = 0; r < R; ++r)
+          best[r] = parents[std::size_t(best[r]) * R + r];
+      }
+
+      // Create children, mutating where the coin word falls under the rate
+      const uint32_t *coin = &words[std::size_t(picks) * R];
+      const uint32_t *dir = coin + R;
+      uint32_t *child = &children[std::size_t(i) * R];
+      for (int r = 0; r < R; ++r)
+        child[r] = (coin[r] < mutate_below) ? fitness_map.neighbor(best[r], dir[r] % NUM_DIRECTIONS) : best[r];
+    }
+  }
+
+  // Swap which array is active
+  first_pop = !first_pop;
+}
+
+/*
+ * Function to build the roulette wheel of every replicate from the gathered parent fitness
+ * Arguments: None
+ * Returns: Nothing
+ */
+void Ensemble::buildRouletteTables()
+{
+  // Same choice as Population::buildRouletteTable, by cell when the map has fewer cells than organisms
+  roulette_by_cell = fitness_map.cells() <= std::size_t(n);
+  roulette_tables.resize(replicates);
+  roulette_cells.resize(replicates);
+  if (roulette_by_cell && cell_counts.size() != fitness_map.cells())
+    cell_counts = AlignedArray<uint32_t>(fitness_map.cells());
+
+  const AlignedArray<uint32_t> &parents = first_pop ? pop1 : pop2;
+  for (int r = 0; r < replicates; ++r)
+  {
+    if (roulette_by_cell)
+    {
+      // Count organisms per cell, noting cells in the order they are first seen
+      std::vector<uint32_t> &cells = roulette_cells[r];
+      cells.clear();
+      for (int i = 0; i < n; ++i)
+      {
+        uint32_t cell = parents[std::size_t(i) * replicates + r];
+        if (cell_counts[cell]++ == 0)
+          cells.push_back(cell);
+      }
+
+      // Weight each occupied cell, leaving counts at 0 for the next replicate
+      roulette_weights.resize(cells.size());
+      for (std::size_t j = 0; j < cells.size(); ++j)
+      {
+        roulette_weights[j] = cell_counts[cells[j]] * fitness_map[cells[j]];
+        cell_counts[cells[j]] = 0;
+      }
+    }
+    else
+    {
+      roulette_weights.resize(n);
+      for (int i = 0; i < n; ++i)
+        roulette_weights[i] = parent_fitness[std::size_t(i) * replicates + r];
+    }
+
+    // Ensure replicate isn't dead
+    if (roulette_tables[r].build(roulette_weights.data(), roulette_weights.size()) == 0)
+    {
+      std::cout << "Population is dead (replicate " << r << "), can't evolve!" << std::endl;
+      exit(1);
+      return;
+    }
+  }
+}
+
+/*
+ * Function to set a new initial population start (saves current populations)
+ * Arguments: None
+ * Returns: None
+ */
+void Ensemble::newInitPop()
+{
+  init_pop = first_pop ? pop1 : pop2;
+}
+
+/*
+ * Function to reset every replicate
+ * Arguments: None
+ * Returns: Nothing
+ */
+void Ensemble::reset()
+{
+  gen = 0;
+  pop1 = init_pop;
+  pop2 = init_pop;
+}
+
+/*
+ * Function to seed the replicates, replicate r gets seed + r
+ * Arguments: Base seed
+ * Returns: Nothing
+ */
+void Ensemble::setSeed(int seed)
+{
+  seeds.resize(replicates);
+  keys.resize(2 * std::size_t(replicates));
+  for (int r = 0; r < replicates; ++r)
+  {
+    seeds[r] = uint64_t(int64_t(seed) + r);
+    keys[r] = uint32_t(seeds[r]);
+    keys[replicates + r] = uint32_t(seeds[r] >> 32);
+  }
+}
+
+/*
+ * Function to get the average fitness of a replicate
+ * Arguments: Replicate
+ * Returns: Mean fitness
+ */
+double Ensemble::meanFitness(int r) const
+{
+  double sum = 0.0;
+  for (int i = 0; i < n; ++i)
+    sum += fitness_map[cell(r, i)];
+  return (n > 0) ? sum / n : 0.0;
+}
+
+/*
+ * Function to get the best fitness in a replicate
+ * Arguments: Replicate
+ * Returns: Max fitness
+ */
+double Ensemble::maxFitness(int r) const
+{
+  double best = 0.0;
+  for (int i = 0; i < n; ++i)
+    best = (i == 0) ? fitness_map[cell(r, i)] : std::max(best, fitness_map[cell(r, i)]);
+  return best;
+}
+
+/*
+ * Function to use a procedural landscape instead of a loaded fitness map, shared by every replicate
+ * Arguments: landscape, width, height, flag to memoize tiles organisms have reached
+ * Returns: Nothing
+ */
+void Ensemble::useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize)
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.setLandscape(landscape, xlim, ylim, memoize))
+    remapOrganisms(old_xlim, old_layout);
+}
+
+/*
+ * Function to change how the fitness map packs cells (Morton keeps nearby genes in nearby memory),
+ * organisms keep their genes
+ * Arguments: cell layout
+ * Returns: Nothing
+ */
+void Ensemble::setCellLayout(CellLayout layout)
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  fitness_map.setLayout(layout);
+  if (fitness_map.layout != old_layout)
+    remapOrganisms(old_xlim, old_layout);
+}
+
+/*
+ * Function to repack organism cells after the fitness map width changed
+ * Arguments: Width and layout the cells were packed with
+ * Returns: Nothing
+ */
+void Ensemble::remapOrganisms(int old_xlim, CellLayout old_layout)
+{
+  auto remap = [this, old_xlim, old_layout](uint32_t &cell)
+  {
+    cell = fitness_map.remapCell(cell, old_xlim, old_layout);
+  };
+
+  for (std::size_t i = 0; i < pop1.size(); ++i)
+  {
+    remap(init_pop[i]);
+    remap(pop1[i]);
+    remap(pop2[i]);
+  }
+}
+
+/*
+ * Function to save one replicate to file, in the same format as Population::savePopulation
+ * Arguments: Replicate, filepath/name to save to
+ * Returns: Nothing
+ */
+void Ensemble::savePopulation(int r, std::string file)
+{
+  std::ofstream f(file);
+
+  f << "N " << n << std::endl;
+  f << "M " << m << std::endl;
+  f << "G " << gen << std::endl;
+
+  for (int i = 0; i < n; ++i)
+    f << fitness_map.getX(cell(r, i)) << " " << fitness_map.getY(cell(r, i)) << " "
+      << fitness_map[cell(r, i)] << std::endl;
+
+  f.close();
+}
+
+/*
+ * Function to load a fitness function from file (2D array), shared by every replicate
+ * Arguments: Filepath/name to load from
+ * Returns: Nothing
+ */
+void Ensemble::loadFitnessFunction(std::string file)
+{
+  // Cells depend on the map width, so repack organisms after loading
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.load(file))
+    remapOrganisms(old_xlim, old_layout);
+}
@@ -0,0 +1,78 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "aligned_array.h"
+#include "alias_table.h"
+#include "fitness_map.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Many independent replicates of one population setup, advanced in lockstep. They share a single
+// fitness map, and organism i of every replicate is stored side by side (index i * replicates + r),
+// so each step of the generation loop runs across replicates as SIMD lanes.
+struct Ensemble
+{
+  int replicates; // Number of independent populations
+  int n; // Number of organisms in each replicate
+  double m; // Mutation rate
+  int gen; // Current generation number, shared by all replicates
+
+  // Counter-based random streams, one Philox key per replicate
+  std::vector<uint64_t> seeds;
+  AlignedArray<uint32_t> keys; // Low 32 bits of every seed, then the high 32 bits
+
+  // Generation step split across threads by child, results don't depend on thread count
+  bool parallel;
+  int threads; // OpenMP threads for parallel mode, 0 uses the OpenMP default
+
+  // Organism storage, cells of organism i in replicate r at i * replicates + r
+  bool first_pop; // Using pop1 if true, else pop2 is current
+  AlignedArray<uint32_t> init_pop; // Initial population, used for resetting
+  AlignedArray<uint32_t> pop1;
+  AlignedArray<uint32_t> pop2;
+  FitnessMap fitness_map;
+
+  // Per generation scratch space
+  AlignedArray<double> parent_fitness; // Laid out like the organisms
+  std::vector<AliasTable> roulette_tables; // One wheel per replicate
+  bool roulette_by_cell; // Wheel slots are roulette_cells entries instead of organisms
+  std::vector<std::vector<uint32_t>> roulette_cells; // Occupied cells of each replicate, when building by cell
+  std::vector<double> roulette_weights;
+  AlignedArray<uint32_t> cell_counts; // Organisms per cell, all 0 between replicates
+
+  // Ensemble constructor
+  Ensemble(int replicates = 8,
+           int n = 10000,
+           double m = 0.01,
+           int xstart = 0,
+           int ystart = 0);
+
+  // Main simulation
+  void evolve(int generations = 100,
+              char selection = 't',
+              int tournament_size = 7,
+              bool save_all = false,
+              std::string save_dir = "./TestData");
+  void nextGeneration(bool roulette, int t);
+  void buildRouletteTables();
+  void newInitPop();
+  void reset();
+  void setSeed(int seed);
+
+  // Per replicate results
+  uint32_t cell(int r, int i) const { return (first_pop ? pop1 : pop2)[std::size_t(i) * replicates + r]; }
+  double meanFitness(int r) const;
+  double maxFitness(int r) const;
+
+  // Fitness map changes, keeps organisms on the same genes
+  void useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize = false);
+  void setCellLayout(CellLayout layout);
+  void remapOrganisms(int old_xlim, CellLayout old_layout);
+
+  // File IO, one replicate at a time in the Population format
+  void savePopulation(int r, std::string file);
+  void loadFitnessFunction(std::string file);
+};
+
+#endif
@@ -1,64 +1,30 @@
 #include "evolution.h"
+#include "thread_count.h"
+#include "engine.h"
+#include "philox.h"
+#include "sampling.h"
 #include <iostream>
 #include <fstream>
-#include "emp/datastructs/IndexMap.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 /*
  * Default constructor for organism
  * Arguments: None
  * Returns: Organism
  */
-Organism::Organism() : x(0), y(0), fit(0.0)
+Organism::Organism() : cell(0)
 {
 }
 
 /*
- * Constructor for organism if coordinates known
- * Arguments: x gene, y gene
+ * Constructor for organism if cell known
+ * Arguments: packed (x, y) gene cell
  * Returns: Organism
  */
-Organism::Organism(int x, int y) : x(x), y(y), fit(0.0)
-{ 
-}
-
-/*
- * Function to get the fitness for the current organism from a fitness map
- * Arguments: None
- * Returns: Nothing
- */
-void Organism::getFitness(emp::array<emp::array<double, MAX_GENE_SIZE>, MAX_GENE_SIZE> &fitness_map)
+Organism::Organism(uint32_t cell) : cell(cell)
 {
-  fit = fitness_map[y][x];
-}
-
-/* 
- * Function to mutate an Organism
- * Arguments: mutation direction
- * Returns: Nothing
- */
-void Organism::mutate(int dir, int xlim, int ylim)
-{
-  switch(dir)
-  {
-  case 0: // increase gene x
-    if (x < xlim - 1)
-      x += 1;
-    break;
-  case 1: // decrease gene x
-    if (x > 0)
-      x -= 1;
-    break;
-  case 2: // increase gene y
-    if (y < ylim - 1)
-      y += 1;
-    break;
-  case 3: // decrease gene y
-    if (y > 0)
-      y -= 1;
-    break;
-  default:
-    std::cout << "ERROR: Invalid mutation direction (" << dir << ")" << std::endl;
-  }
 }
 
 /*
@@ -67,41 +33,53 @@ void Organism::mutate(int dir, int xlim, int ylim)
  *            and fitness map file to load from
  * Returns: Population
  */
-Population::Population(int n, double m, int xstart, int ystart) : n(n), m(m)
+Population::Population(int n, double m, int xstart, int ystart) :
+  n(n),
+  m(m),
+  init_pop(n),
+  pop1(n),
+  pop2(n),
+  fitness_map(std::max(DEFAULT_GENE_SIZE, xstart + 1), std::max(DEFAULT_GENE_SIZE, ystart + 1))
 {
-  if (n > MAX_POP_SIZE)
-  {
-    this->n = MAX_POP_SIZE;
-    n = MAX_POP_SIZE;
-    std::cout << "Population size exceeds limit, limiting to " << MAX_POP_SIZE << "!" << std::endl;
-  }
-
   gen = 0; // Generation number, starts at 0
-  
-  // Initialize fitness map to all 0s
-  for (int i = 0; i < MAX_GENE_SIZE; ++i)
-    for (int j = 0; j < MAX_GENE_SIZE; ++j)
-      fitness_map[i][j] = 0;
+  seed = uint64_t(rng.GetSeed());
+  parallel = false;
+  threads = 0;
+  ranked_tournament = false;
+  rank_pressure = DEFAULT_RANK_PRESSURE;
+  truncation_share = DEFAULT_TRUNCATION_SHARE;
+  boundary = BOUNDARY_CLAMP;
+  geometric_mutation = false;
+  batched_rng = false;
+  simd_level = detectSimdLevel();
+  bucket_by_cell = false;
+  reorder_interval = 0;
+  cells_sorted = false;
+  run_lookup_bits = 0;
+  steady_state = false;
+  steady_batch = STEADY_STATE_BATCH;
+  check_interval = 0;
+  monomorphic_share = 0.0;
+  stable_window = 0;
+  stable_tolerance = 0.0;
+  target_fitness = std::numeric_limits<double>::infinity();
+  stop_reason = STOP_NONE;
+  stable_since = 0;
+  fast_forward = false;
+  skipped_generations = 0;
 
-  // Initialize population at center of current genetic map
+  // Initialize population at start of current genetic map (fitness map starts as all 0s)
   first_pop = true;
   for (int i = 0; i < n; ++i)
-  {
-    pop1[i].x = xstart;
-    pop1[i].y = ystart;
-    pop1[i].getFitness(fitness_map);
-  }
-
-  // Initialize roulette map with size n
-  roulette_map = emp::IndexMap(n);
+    pop1[i].cell = fitness_map.toCell(xstart, ystart);
 }
 
 /*
- * Function that will simulate generations of a population
+ * Function that will simulate generations of a population, stopping early if a stopping rule is met
  * Arguments: How many generations, flag for selection method, tournament size to be used, and flag for saving
- * Returns: Nothing
+ * Returns: Generation it stopped at
  */
-void Population::evolve(int generations, char selection, int tournament_size, bool save_all, std::string save_dir)
+int Population::evolve(int generations, char selection, int tournament_size, bool save_all, std::string save_dir)
 {
   std::string file_start = save_dir.append("gen_"); // File path to save to, gen_#, # is determined later
   
@@ -109,9 +87,15 @@ void Population::evolve(int generations, char selection, int tournament_size, bo
   if (n == 0)
   {
     std::cout << "Cannot evolve with an empty population" << std::endl;
-    return;
+    return gen;
   }
 
+  // Stable windows start over each run
+  stop_reason = STOP_NONE;
+  stable_histogram.clear();
+  skipped_generations = 0;
+  int last_check = 0;
+
   // Track generations
   // std::cout << "Generation " << gen << ", " << n << " organisms!" << std::endl;
   std::string file;
@@ -126,18 +110,24 @@ void Population::evolve(int generations, char selection, int tournament_size, bo
     // Next generation
     ++gen;
 
-    // Create children based on fitness, track mutations
-    switch(selection)
+    // Scheduled landscape changes take effect before this generation's children are made
+    if (schedule.due(gen))
+      applySchedule();
+
+    // Create children based on fitness, track mutations. Quiescent stretches are skipped in one
+    // draw, populations in them are never seen so this is only done without saving. A jump stops
+    // short of the next landscape change.
+    int covered = 0;
+    if (fast_forward && !save_all && !steady_state)
+      covered = fastForward(selection, std::min(generations - i, schedule.nextGen() - gen));
+    if (covered > 1)
     {
-    case 't':
-      selectionTournament(tournament_size);
-      break;
-    case 'r':
-      selectionRoulette();
-      break;
-    default:
-      selectionTournament(7);
+      gen += covered - 1;
+      i += covered - 1;
+      skipped_generations += covered - 1;
     }
+    else if (covered == 0)
+      nextGeneration(selection, tournament_size);
     
     //if ((i + 1) % 100 == 0)
     //{
@@ -150,32 +140,360 @@ void Population::evolve(int generations, char selection, int tournament_size, bo
       file = file_start + std::to_string(gen) + ".txt";
       savePopulation(file);
     }
+
+    if (check_interval > 0 && i + 1 - last_check >= check_interval)
+    {
+      last_check = i + 1;
+      if (converged())
+        break;
+    }
   }
+  return gen;
 }
 
 /*
- * Function to set a new initial population start (saves current population)
- * Arguments: None
- * Returns: None
+ * Function to jump over generations where nothing can change. When every organism that can be
+ * picked as a parent is on one cell, each generation copies that cell and a child only matters if
+ * it mutates off it. The generations until one does are geometric, with a chance of
+ * 1 - (1 - m * k / 4)^n each (k directions leading off the cell). Under roulette, children on 0
+ * fitness cells are never parents, so those directions are dead ends that don't end the wait.
+ * The generation that ends the wait (or the last one asked for) is then drawn exactly, given it
+ * ends it (or doesn't).
+ * With a monomorphic_share below 1, the population also counts as quiescent when one cell holds
+ * that share and the rest sit on neighbors selected against (under roulette, by more than drift
+ * can undo in n organisms). Those neighbors are dead ends too: the cloud of mutants on them is
+ * kept at mutation-selection balance and only mutants reaching a neutral or better neighbor can
+ * fix, so they end the wait. This is approximate, cloud organisms are assumed to never be parents
+ * of such a mutant, and the generation filled in draws the cloud afresh with its current share on
+ * each neighbor (at least m / 4). A wait that ends this generation runs it as usual instead.
+ * Arguments: flag for selection method, generations left
+ * Returns: Generations covered (the last one filled in as the current population), 0 if the
+ *          population isn't quiescent
  */
-void Population::newInitPop()
+int Population::fastForward(char selection, int remaining)
 {
-  if (first_pop)
+  AlignedArray<Organism> &current = first_pop ? pop1 : pop2;
+  bool roulette = (selection == 'r' || selection == 'u'); // Fitness proportional, 0 fitness organisms can't be parents
+  bool nearly = (monomorphic_share > 0.0 && monomorphic_share < 1.0);
+
+  // Find the cell parents come from, when nearly monomorphic the one most organisms are on (by
+  // majority vote, so shares below one half act as one half)
+  bool found = false;
+  uint32_t cell = 0;
+  if (nearly)
   {
+    int votes = 0;
     for (int i = 0; i < n; ++i)
     {
-      init_pop[i].x = pop1[i].x;
-      init_pop[i].y = pop1[i].y;
+      if (votes == 0)
+        cell = current[i].cell;
+      votes += (current[i].cell == cell) ? 1 : -1;
     }
+    found = (fitness_map[cell] > 0);
   }
   else
   {
     for (int i = 0; i < n; ++i)
     {
-      init_pop[i].x = pop2[i].x;
-      init_pop[i].y = pop2[i].y;
+      if (roulette && current[i].getFitness(fitness_map) <= 0)
+        continue;
+      if (found && current[i].cell != cell)
+        return 0;
+      cell = current[i].cell;
+      found = true;
+    }
+  }
+  if (!found)
+    return 0;
+
+  // Directions off the cell, split into those that end the wait and dead ends
+  double fit = fitness_map[cell];
+  uint32_t live[NUM_DIRECTIONS];
+  uint32_t dead[NUM_DIRECTIONS];
+  int num_live = 0;
+  int num_dead = 0;
+  for (int dir = 0; dir < NUM_DIRECTIONS; ++dir)
+  {
+    uint32_t to = fitness_map.step(cell, dir, boundary);
+    if (to == cell)
+      continue;
+    double to_fit = fitness_map[to];
+    bool selected_against = (to_fit < fit) && (!roulette || n * (1.0 - to_fit / fit) >= 1.0);
+    if ((roulette && to_fit <= 0) || (nearly && selected_against))
+      dead[num_dead++] = to;
+    else
+      live[num_live++] = to;
+  }
+  double q_live = m * num_live / double(NUM_DIRECTIONS);
+  double q_dead = m * num_dead / double(NUM_DIRECTIONS);
+
+  // Nearly monomorphic, everything off the cell must be in the cloud (or unable to be a parent).
+  // Each dead end keeps the cloud's share on it, at least the new mutants it gets every generation.
+  double cloud[NUM_DIRECTIONS] = {};
+  if (nearly)
+  {
+    int on_cell = 0;
+    for (int i = 0; i < n; ++i)
+    {
+      if (current[i].cell == cell)
+      {
+        ++on_cell;
+        continue;
+      }
+      int j = 0;
+      while (j < num_dead && dead[j] != current[i].cell)
+        ++j;
+      if (j < num_dead)
+        cloud[j] += 1.0 / n;
+      else if (!roulette || current[i].getFitness(fitness_map) > 0)
+        return 0;
+    }
+    if (on_cell < monomorphic_share * n)
+      return 0;
+
+    q_dead = 0.0;
+    for (int j = 0; j < num_dead; ++j)
+    {
+      cloud[j] = std::max(cloud[j], m / double(NUM_DIRECTIONS));
+      q_dead += cloud[j];
     }
   }
+
+  // Generations where no child reaches a live direction
+  double log_stay = n * std::log1p(-std::min(q_live, 1.0));
+  uint64_t wait = sampleGeometric(rng, log_stay);
+  bool escape = wait < uint64_t(remaining);
+  if (nearly && wait == 0)
+    return 0;
+
+  // Dead ends are picked evenly, or by the cloud's share on each
+  auto deadEnd = [&]()
+  {
+    if (!nearly)
+      return dead[rng.GetInt(0, num_dead)];
+    double u = rng.GetDouble() * q_dead;
+    int j = 0;
+    while (j < num_dead - 1 && (u -= cloud[j]) >= 0)
+      ++j;
+    return dead[j];
+  };
+
+  // Children before the first live one (all of them without an escape) can only stay or hit a dead end
+  int first_live = n;
+  if (escape)
+  {
+    double p_escape = -std::expm1(log_stay);
+    first_live = std::min(int(std::log1p(-rng.GetDouble() * p_escape) / std::log1p(-q_live)), n - 1);
+  }
+  double p_dead_before = (q_live < 1.0) ? q_dead / (1.0 - q_live) : 0.0;
+  for (int i = 0; i < n; ++i)
+  {
+    current[i].cell = cell;
+    if (i < first_live)
+    {
+      if (num_dead > 0 && rng.P(p_dead_before))
+        current[i].cell = deadEnd();
+    }
+    else if (i == first_live)
+      current[i].cell = live[rng.GetInt(0, num_live)];
+    else
+    {
+      // After the first live child, children mutate as usual
+      double u = rng.GetDouble();
+      if (u < q_live)
+        current[i].cell = live[rng.GetInt(0, num_live)];
+      else if (u < q_live + q_dead)
+        current[i].cell = deadEnd();
+    }
+  }
+
+  cells_sorted = false;
+  return escape ? int(wait) + 1 : remaining;
+}
+
+/*
+ * Function to check the stopping rules against the current population
+ * Arguments: None
+ * Returns: True if a rule is met (stop_reason says which)
+ */
+bool Population::converged()
+{
+  const AlignedArray<Organism> &current = first_pop ? pop1 : pop2;
+
+  // Strictly monomorphic is one scan, a smaller share needs the histogram
+  std::vector<std::pair<uint32_t, uint32_t>> histogram;
+  if (monomorphic_share >= 1.0)
+  {
+    int i = 1;
+    while (i < n && current[i].cell == current[0].cell)
+      ++i;
+    if (i == n)
+    {
+      stop_reason = STOP_MONOMORPHIC;
+      return true;
+    }
+  }
+  else if (monomorphic_share > 0.0)
+  {
+    histogram = occupancy();
+    for (auto &h : histogram)
+    {
+      if (h.second >= monomorphic_share * n)
+      {
+        stop_reason = STOP_MONOMORPHIC;
+        return true;
+      }
+    }
+  }
+
+  if (target_fitness < std::numeric_limits<double>::infinity())
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      if (current[i].getFitness(fitness_map) >= target_fitness)
+      {
+        stop_reason = STOP_TARGET;
+        return true;
+      }
+    }
+  }
+
+  if (stable_window > 0)
+  {
+    // Organisms that moved between the histograms, each move changes two counts
+    if (histogram.empty())
+      histogram = occupancy();
+    uint64_t changed = 0;
+    std::size_t a = 0;
+    std::size_t b = 0;
+    while (a < histogram.size() || b < stable_histogram.size())
+    {
+      if (b == stable_histogram.size() || (a < histogram.size() && histogram[a].first < stable_histogram[b].first))
+        changed += histogram[a++].second;
+      else if (a == histogram.size() || stable_histogram[b].first < histogram[a].first)
+        changed += stable_histogram[b++].second;
+      else
+      {
+        changed += std::max(histogram[a].second, stable_histogram[b].second) - std::min(histogram[a].second, stable_histogram[b].second);
+        ++a;
+        ++b;
+      }
+    }
+
+    // A change restarts the window from this histogram
+    if (stable_histogram.empty() || changed > 2 * stable_tolerance * n)
+    {
+      stable_histogram.swap(histogram);
+      stable_since = gen;
+    }
+    else if (gen - stable_since >= stable_window)
+    {
+      stop_reason = STOP_STABLE;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Function to count the organisms on each occupied cell of the current population
+ * Arguments: None
+ * Returns: (cell, organisms) pairs in cell order
+ */
+std::vector<std::pair<uint32_t, uint32_t>> Population::occupancy() const
+{
+  const AlignedArray<Organism> &current = first_pop ? pop1 : pop2;
+  std::vector<uint32_t> cells(n);
+  for (int i = 0; i < n; ++i)
+    cells[i] = current[i].cell;
+  std::sort(cells.begin(), cells.end());
+
+  std::vector<std::pair<uint32_t, uint32_t>> histogram;
+  for (uint32_t cell : cells)
+  {
+    if (!histogram.empty() && histogram.back().first == cell)
+      ++histogram.back().second;
+    else
+      histogram.push_back(std::make_pair(cell, 1));
+  }
+  return histogram;
+}
+
+/*
+ * Function to create the next generation with the configured selection method
+ * Arguments: flag for selection method, tournament size to be used
+ * Returns: Nothing
+ */
+void Population::nextGeneration(char selection, int tournament_size)
+{
+  // Memoized landscapes fill the tiles parents sit on now, so the (maybe parallel) lookups are read only
+  if (fitness_map.memoize && fitness_map.storage == STORAGE_PROCEDURAL)
+  {
+    const AlignedArray<Organism> &parents = first_pop ? pop1 : pop2;
+    for (int i = 0; i < n; ++i)
+      fitness_map.memoizeCell(parents[i].cell);
+  }
+
+  // Steady state generations work in place, the rest need the second array
+  cells_sorted = false;
+  if (steady_state)
+  {
+    selectionSteadyState(selection, tournament_size);
+    return;
+  }
+  if (pop2.size() != std::size_t(n))
+    pop2.resize(n);
+
+  // Organisms in cell order make the per generation fitness lookups sequential
+  if (reorder_interval > 0 && gen % reorder_interval == 0)
+    sortByCell();
+
+  switch(selection)
+  {
+  case 'r':
+    if (batched_rng)
+      selectionBatched('r', 0);
+    else if (parallel)
+      selectionRouletteParallel();
+    else
+      selectionRoulette();
+    break;
+  case 'u':
+    selectionUniversal();
+    break;
+  case 'k':
+    selectionLinearRank();
+    break;
+  case 'c':
+    selectionTruncation();
+    break;
+  case 't':
+  default:
+    int t = (selection == 't') ? tournament_size : 7;
+    if (ranked_tournament)
+      selectionTournamentRanked(t);
+    else if (batched_rng)
+      selectionBatched('t', t);
+    else if (parallel)
+      selectionTournamentParallel(t);
+    else
+      selectionTournament(t);
+  }
+}
+
+/*
+ * Function to set a new initial population start (saves current population)
+ * Arguments: None
+ * Returns: None
+ */
+void Population::newInitPop()
+{
+  if (first_pop)
+    for (int i = 0; i < n; ++i)
+      init_pop[i] = pop1[i];
+  else
+    for (int i = 0; i < n; ++i)
+      init_pop[i] = pop2[i];
 }
 
 /*
@@ -186,15 +504,49 @@ void Population::newInitPop()
 void Population::reset()
 {
   gen = 0;
+  first_pop = true;
   for (int i = 0; i < n; ++i)
+    pop1[i] = init_pop[i];
+}
+
+/*
+ * Function to change the population size, new organisms copy existing ones in order
+ * Arguments: New number of organisms
+ * Returns: Nothing
+ */
+void Population::resize(int new_n)
+{
+  if (new_n < 1)
   {
-    pop1[i].x = init_pop[i].x;
-    pop1[i].y = init_pop[i].y;
-    pop1[i].getFitness(fitness_map);
-    pop2[i].x = init_pop[i].x;
-    pop2[i].y = init_pop[i].y;
-    pop2[i].getFitness(fitness_map);
+    std::cout << "Population size must be at least 1!" << std::endl;
+    return;
   }
+
+  init_pop.resize(new_n);
+  pop1.resize(new_n);
+  if (!pop2.empty())
+    pop2.resize(new_n);
+
+  // Fill new slots by cycling through the old organisms
+  AlignedArray<Organism> &current = first_pop ? pop1 : pop2;
+  for (int i = n; i < new_n && n > 0; ++i)
+  {
+    init_pop[i] = init_pop[i % n];
+    current[i] = current[i % n];
+  }
+
+  n = new_n;
+}
+
+/*
+ * Function to seed both the serial generator and the parallel streams
+ * Arguments: Seed value
+ * Returns: Nothing
+ */
+void Population::setSeed(int seed)
+{
+  rng.ResetSeed(seed);
+  this->seed = uint64_t(seed);
 }
 
 /*
@@ -204,136 +556,717 @@ void Population::reset()
  */ 
 void Population::selectionTournament(int t)
 {
-  if (first_pop)
+  // Determine if pop1 or pop2 has current population
+  AlignedArray<Organism> &parents = first_pop ? pop1 : pop2;
+  AlignedArray<Organism> &children = first_pop ? pop2 : pop1;
+
+  // Compare fitness levels when the map has them (1 byte for small palettes, else 2), they order
+  // the same as the values
+  bool levels = fitness_map.updateLevels();
+  if (levels && !fitness_map.byte_levels.empty())
+    dispatchGeneration(fitness_map, parents.data(), children.data(), n, m,
+                       TournamentSelection<ByteLevelFitness>{fitness_map, t}, rng, geometric_mutation, boundary);
+  else if (levels)
+    dispatchGeneration(fitness_map, parents.data(), children.data(), n, m,
+                       TournamentSelection<LevelFitness>{fitness_map, t}, rng, geometric_mutation, boundary);
+  else
+    dispatchGeneration(fitness_map, parents.data(), children.data(), n, m,
+                       TournamentSelection<ValueFitness>{fitness_map, t}, rng, geometric_mutation, boundary);
+
+  // Change to use other array
+  first_pop = !first_pop;
+}
+
+/*
+ * Function to perform roulette selection
+ * Arguments: None
+ * Returns: Nothing
+ */
+void Population::selectionRoulette()
+{
+  // Determine if pop1 or pop2 has current population
+  AlignedArray<Organism> &parents = first_pop ? pop1 : pop2;
+  AlignedArray<Organism> &children = first_pop ? pop2 : pop1;
+
+  // Ensure population isn't dead
+  if (buildRouletteTable(parents) == 0)
+  {
+    std::cout << "Population is dead (" << (first_pop ? "pop1" : "pop2") << "), can't evolve!" << std::endl;
+    exit(1);
+    return;
+  }
+
+  dispatchGeneration(fitness_map, parents.data(), children.data(), n, m,
+                     RouletteSelection{roulette_table, roulette_by_cell ? roulette_cells.data() : nullptr},
+                     rng, geometric_mutation, boundary);
+
+  // Swap which array is active
+  first_pop = !first_pop;
+}
+
+/*
+ * Function to perform stochastic universal sampling: one random offset places n evenly spaced
+ * pointers on the roulette weights, and a single pass in slot order resolves them all. Each parent
+ * gets the floor or ceiling of its expected children, so there is less sampling noise than n spins.
+ * Serial, the parallel and batched modes are ignored.
+ * Arguments: None
+ * Returns: Nothing
+ */
+void Population::selectionUniversal()
+{
+  // Determine if pop1 or pop2 has current population
+  AlignedArray<Organism> &parents = first_pop ? pop1 : pop2;
+  AlignedArray<Organism> &children = first_pop ? pop2 : pop1;
+
+  // Ensure population isn't dead
+  double total = buildRouletteWeights(parents);
+  if (total == 0)
   {
+    std::cout << "Population is dead (" << (first_pop ? "pop1" : "pop2") << "), can't evolve!" << std::endl;
+    exit(1);
+    return;
+  }
+
+  std::size_t last = roulette_weights.size() - 1;
+  while (last > 0 && roulette_weights[last] == 0)
+    --last;
+
+  double spacing = total / n;
+  dispatchGeneration(fitness_map, parents.data(), children.data(), n, m,
+                     UniversalSelection{roulette_weights.data(), roulette_by_cell ? roulette_cells.data() : nullptr,
+                                        last, spacing, rng.GetDouble() * spacing, 0, roulette_weights[0], 0},
+                     rng, geometric_mutation, boundary);
+
+  // Swap which array is active
+  first_pop = !first_pop;
+}
+
+/*
+ * Function to build the roulette wheel for a generation
+ * Arguments: Current population
+ * Returns: Total fitness of the population
+ */
+double Population::buildRouletteTable(const AlignedArray<Organism> &parents)
+{
+  buildRouletteWeights(parents);
+  return roulette_table.build(roulette_weights.data(), roulette_weights.size());
+}
+
+/*
+ * Function to weight the roulette slots for a generation. Organisms on the same cell are
+ * identical, so when the map has no more cells than organisms there is one slot per occupied
+ * cell (weighted by count * fitness) instead of one per organism.
+ * Arguments: Current population
+ * Returns: Total fitness of the population, summed in slot order
+ */
+double Population::buildRouletteWeights(const AlignedArray<Organism> &parents)
+{
+  roulette_by_cell = fitness_map.cells() <= std::size_t(n);
+  double total = 0.0;
+
+  if (!roulette_by_cell)
+  {
+    roulette_weights.resize(n);
     for (int i = 0; i < n; ++i)
     {
-      // Parent selection process, select t organisms for tournament
-      int max_parent = rng.GetInt(0, n);
-      for (int i = 0; i < t - 1; ++i)
+      roulette_weights[i] = parents[i].getFitness(fitness_map);
+      total += roulette_weights[i];
+    }
+    return total;
+  }
+
+  // Count organisms per cell, noting cells in the order they are first seen
+  if (cell_counts.size() != fitness_map.cells())
+    cell_counts = AlignedArray<uint32_t>(fitness_map.cells());
+  roulette_cells.clear();
+  for (int i = 0; i < n; ++i)
+    if (cell_counts[parents[i].cell]++ == 0)
+      roulette_cells.push_back(parents[i].cell);
+
+  // Weight each occupied cell, leaving counts at 0 for next generation
+  roulette_weights.resize(roulette_cells.size());
+  for (std::size_t i = 0; i < roulette_cells.size(); ++i)
+  {
+    uint32_t cell = roulette_cells[i];
+    roulette_weights[i] = cell_counts[cell] * fitness_map[cell];
+    total += roulette_weights[i];
+    cell_counts[cell] = 0;
+  }
+  return total;
+}
+
+/*
+ * Function that creates a new generation via tournament selection, children split across threads
+ * Arguments: Tournament size
+ * Returns: Nothing
+ */
+void Population::selectionTournamentParallel(int t)
+{
+  // Determine if pop1 or pop2 has current population
+  AlignedArray<Organism> &parents = first_pop ? pop1 : pop2;
+  AlignedArray<Organism> &children = first_pop ? pop2 : pop1;
+
+  #pragma omp parallel for num_threads(threadCount(threads)) schedule(static)
+  for (int i = 0; i < n; ++i)
+  {
+    // Each child draws from its own stream, keyed by seed, generation and child index
+    PhiloxStream child_rng(seed, gen, i);
+
+    // Parent selection process, select t organisms for tournament
+    int max_parent = child_rng.GetInt(0, n);
+    double max_fit = parents[max_parent].getFitness(fitness_map);
+    for (int j = 0; j < t - 1; ++j)
+    {
+      int parent = child_rng.GetInt(0, n);
+      double fit = parents[parent].getFitness(fitness_map);
+      if (fit > max_fit)
       {
-        int parent = rng.GetInt(0, n);
-        max_parent = (pop1[parent].fit > pop1[max_parent].fit) ? parent : max_parent;
+        max_parent = parent;
+        max_fit = fit;
       }
+    }
 
-      // Create child
-      pop2[i].x = pop1[max_parent].x;
-      pop2[i].y = pop1[max_parent].y;
+    // Create child
+    children[i] = parents[max_parent];
 
-      // Check if there's a mutation
-      if (rng.P(m))
-        pop2[i].mutate(rng.GetInt(0, 4), xlim, ylim);
-    
-      // Get organism's fitness
-      pop2[i].getFitness(fitness_map);
+    // Check if there's a mutation
+    if (child_rng.P(m))
+      children[i].mutate(child_rng.GetInt(0, 4), fitness_map, boundary);
+  }
+
+  // Change to use other array
+  first_pop = !first_pop;
+}
+
+/*
+ * Function to perform roulette selection, children split across threads
+ * Arguments: None
+ * Returns: Nothing
+ */
+void Population::selectionRouletteParallel()
+{
+  // Determine if pop1 or pop2 has current population
+  AlignedArray<Organism> &parents = first_pop ? pop1 : pop2;
+  AlignedArray<Organism> &children = first_pop ? pop2 : pop1;
+
+  // Ensure population isn't dead, the table is built serially so every thread count sees the same wheel
+  if (buildRouletteTable(parents) == 0)
+  {
+    std::cout << "Population is dead (" << (first_pop ? "pop1" : "pop2") << "), can't evolve!" << std::endl;
+    exit(1);
+    return;
+  }
+
+  #pragma omp parallel for num_threads(threadCount(threads)) schedule(static)
+  for (int i = 0; i < n; ++i)
+  {
+    // Each child draws from its own stream, keyed by seed, generation and child index
+    PhiloxStream child_rng(seed, gen, i);
+
+    // Select random parent via roulette style, O(1) per spin
+    uint32_t slot = roulette_table.sample(child_rng);
+
+    // Create child
+    children[i].cell = roulette_by_cell ? roulette_cells[slot] : parents[slot].cell;
+
+    // Check if there's a mutation
+    if (child_rng.P(m))
+      children[i].mutate(child_rng.GetInt(0, 4), fitness_map, boundary);
+  }
+
+  // Swap which array is active
+  first_pop = !first_pop;
+}
+
+/*
+ * Function that creates a new generation from a fitness ranking, drawing each parent's rank from
+ * the rank policy. Ties go to a uniform pick among organisms with the same fitness, so equally fit
+ * organisms are equally likely parents. O(1) per child after the O(n) ranking.
+ * Arguments: Rank policy
+ * Returns: Nothing
+ */
+template <typename Rank>
+void Population::selectionByRank(const Rank &rank_policy)
+{
+  AlignedArray<Organism> &parents = first_pop ? pop1 : pop2;
+  AlignedArray<Organism> &children = first_pop ? pop2 : pop1;
+
+  rankPopulation(parents);
+
+  auto makeChild = [&](auto &child_rng, int i)
+  {
+    // Rank of the parent, then a uniform pick among its ties
+    std::size_t rank = std::size_t(n * rank_policy.position(child_rng.GetDouble()));
+    if (rank >= std::size_t(n))
+      rank = n - 1;
+    uint32_t group = ranked_group[rank];
+    uint32_t first = group_start[group];
+    uint32_t ties = group_start[group + 1] - first;
+    children[i].cell = ranked_cells[(ties > 1) ? first + child_rng.GetInt(0, ties) : first];
+
+    // Check if there's a mutation
+    if (child_rng.P(m))
+      children[i].mutate(child_rng.GetInt(0, 4), fitness_map, boundary);
+  };
+
+  if (parallel)
+  {
+    #pragma omp parallel for num_threads(threadCount(threads)) schedule(static)
+    for (int i = 0; i < n; ++i)
+    {
+      PhiloxStream child_rng(seed, gen, i);
+      makeChild(child_rng, i);
     }
   }
-  else // If current population is in pop2
+  else
   {
     for (int i = 0; i < n; ++i)
+      makeChild(rng, i);
+  }
+
+  // Change to use other array
+  first_pop = !first_pop;
+}
+
+/*
+ * Function that creates a new generation via tournament selection, drawing each winner's rank
+ * directly. The best of t uniform picks from n has rank floor(n * u^(1/t)), and ties go to the
+ * first organism drawn, so the winner is uniform among organisms with the same fitness as that
+ * rank. This matches selectionTournament's probabilities at O(1) cost per child.
+ * Arguments: Tournament size
+ * Returns: Nothing
+ */
+void Population::selectionTournamentRanked(int t)
+{
+  t = std::max(t, 1);
+  selectionByRank(TournamentRank{double(t), 1.0 / t});
+}
+
+/*
+ * Function that creates a new generation via linear rank selection, parents are picked by their
+ * place in the fitness ranking rather than by fitness, so the pressure holds as fitness converges
+ * Arguments: None
+ * Returns: Nothing
+ */
+void Population::selectionLinearRank()
+{
+  selectionByRank(LinearRank{std::min(std::max(rank_pressure, 1.0), 2.0)});
+}
+
+/*
+ * Function that creates a new generation via truncation selection, parents are uniform over the
+ * fittest truncation_share of the population
+ * Arguments: None
+ * Returns: Nothing
+ */
+void Population::selectionTruncation()
+{
+  double kept = std::min(truncation_share, 1.0);
+  if (!(kept > 0))
+    kept = 1.0 / n;
+  selectionByRank(TruncationRank{kept});
+}
+
+/*
+ * Function that creates a new generation from bulk random numbers. Children are made in blocks of
+ * RNG_BLOCK: one Philox fill supplies every parent pick of the block, then mutated children are
+ * found by drawing the geometric gap to the next one instead of a coin flip per child. Blocks use
+ * their own counter-based streams, so they can run on any number of threads with the same result.
+ * Arguments: flag for selection method ('r' roulette, otherwise tournament), tournament size
+ * Returns: Nothing
+ */
+void Population::selectionBatched(char selection, int t)
+{
+  AlignedArray<Organism> &parents = first_pop ? pop1 : pop2;
+  AlignedArray<Organism> &children = first_pop ? pop2 : pop1;
+
+  bool roulette = (selection == 'r');
+  if (roulette && buildRouletteTable(parents) == 0)
+  {
+    std::cout << "Population is dead (" << (first_pop ? "pop1" : "pop2") << "), can't evolve!" << std::endl;
+    exit(1);
+    return;
+  }
+
+  t = std::max(t, 1);
+  int words_per_child = roulette ? 2 : t; // A roulette spin takes a 53 bit double
+  int blocks = (n + RNG_BLOCK - 1) / RNG_BLOCK;
+  double log_keep = std::log1p(-std::min(m, 1.0)); // log(1 - m), gaps between mutated children
+
+  // Runs of organisms on one cell stand in for the organisms when there are few enough
+  bool runs = !roulette && bucket_by_cell && buildCellRuns(parents);
+  if (!roulette && !runs)
+    parent_fitness.resize(n);
+
+  #pragma omp parallel num_threads(parallel ? threadCount(threads) : 1)
+  {
+    std::vector<uint32_t> words(std::size_t(RNG_BLOCK) * words_per_child);
+    std::vector<uint32_t> winners(roulette ? 0 : RNG_BLOCK);
+
+    // Tournaments compare fitness many times per parent, so look each one up once
+    if (!roulette && !runs)
     {
-      // Parent selection process, select t organisms for tournament
-      int max_parent = rng.GetInt(0, n);
-      for (int i = 0; i < t - 1; ++i)
+      static_assert(sizeof(Organism) == sizeof(uint32_t), "Organisms are gathered as packed cells");
+      const uint32_t *cells = reinterpret_cast<const uint32_t *>(parents.data());
+
+      #pragma omp for schedule(static)
+      for (int b = 0; b < blocks; ++b)
       {
-        int parent = rng.GetInt(0, n);
-        max_parent = (pop2[parent].fit > pop2[max_parent].fit) ? parent : max_parent;
+        int first = b * RNG_BLOCK;
+        int count = std::min(RNG_BLOCK, n - first);
+        if (fitness_map.storage == STORAGE_DENSE)
+          gatherFitness(simd_level, fitness_map.fitness.data(), cells + first, count, parent_fitness.data() + first);
+        else if (fitness_map.storage == STORAGE_PALETTE && !fitness_map.byte_levels.empty())
+          for (int i = first; i < first + count; ++i)
+            parent_fitness[i] = fitness_map.level_values[fitness_map.byte_levels[cells[i]]];
+        else
+          for (int i = first; i < first + count; ++i)
+            parent_fitness[i] = fitness_map[cells[i]];
       }
+    }
+
+    #pragma omp for schedule(static)
+    for (int b = 0; b < blocks; ++b)
+    {
+      int first = b * RNG_BLOCK;
+      int count = std::min(RNG_BLOCK, n - first);
 
-      // Create child
-      pop1[i].x = pop2[max_parent].x;
-      pop1[i].y = pop2[max_parent].y;
+      // Bulk stage, all parent picks for the block (stream index 2b, mutations use 2b + 1)
+      std::size_t num_words = std::size_t(count) * words_per_child;
+      philoxFill(seed, gen, 2 * b, words.data(), num_words);
 
-      // Check if there's a mutation
-      if (rng.P(m))
-        pop1[i].mutate(rng.GetInt(0, 4), xlim, ylim);
-    
-      // Get organism's (new) fitness
-      pop1[i].getFitness(fitness_map);
+      if (roulette)
+      {
+        for (int j = 0; j < count; ++j)
+        {
+          uint64_t hi = words[2 * j] >> 5;
+          uint64_t lo = words[2 * j + 1] >> 6;
+          uint32_t slot = roulette_table.pick((hi * 67108864.0 + lo) * (1.0 / 9007199254740992.0));
+          children[first + j].cell = roulette_by_cell ? roulette_cells[slot] : parents[slot].cell;
+        }
+      }
+      else if (runs)
+      {
+        // Same picks as below, but the organism is replaced by its run, so the tournament compares
+        // run fitness (in cache) and the winner's cell comes from the run
+        for (std::size_t w = 0; w < num_words; ++w)
+          words[w] = runOfWord(words[w]);
+
+        tournamentWinners(simd_level, run_fitness.data(), words.data(), count, t, winners.data());
+        for (int j = 0; j < count; ++j)
+          children[first + j].cell = run_cells[winners[j]];
+      }
+      else
+      {
+        // Map each word to a parent with a multiply and shift, row k holds every child's k-th pick
+        for (std::size_t w = 0; w < num_words; ++w)
+          words[w] = uint32_t((uint64_t(words[w]) * n) >> 32);
+
+        tournamentWinners(simd_level, parent_fitness.data(), words.data(), count, t, winners.data());
+        for (int j = 0; j < count; ++j)
+          children[first + j] = parents[winners[j]];
+      }
+
+      // Mutation stage, jump straight from one mutated child to the next
+      PhiloxStream mutation_rng(seed, gen, 2 * b + 1);
+      uint64_t j = sampleGeometric(mutation_rng, log_keep);
+      while (j < uint64_t(count))
+      {
+        children[first + j].mutate(mutation_rng.GetUInt() % NUM_DIRECTIONS, fitness_map, boundary);
+        uint64_t gap = sampleGeometric(mutation_rng, log_keep);
+        if (gap >= uint64_t(count))
+          break;
+        j += 1 + gap;
+      }
     }
   }
-  
+
   // Change to use other array
   first_pop = !first_pop;
 }
 
 /*
- * Function to perform roulette selection
- * Arguments: None
+ * Function to run a steady state generation: n births, a batch at a time, each child replacing a
+ * uniformly random organism. Roulette picks by stochastic acceptance since there is no wheel to
+ * rebuild as the population changes.
+ * Arguments: flag for selection method, tournament size
  * Returns: Nothing
  */
-void Population::selectionRoulette()
+void Population::selectionSteadyState(char selection, int t)
 {
-  // Determine if pop1 or pop2 has current population
-  if (first_pop)
+  // Keep the population in pop1 and free the other array
+  if (!first_pop)
+    std::swap(pop1, pop2);
+  first_pop = true;
+  pop2.clear();
+
+  int batch = std::max(1, std::min(steady_batch, n));
+  if (steady_scratch.size() != std::size_t(batch))
+    steady_scratch = AlignedArray<Organism>(batch);
+
+  // Universal sampling needs a fixed wheel, so in place it is fitness proportional picks like roulette
+  if (selection == 'r' || selection == 'u')
   {
-    // Calculate the index map (would it be faster to make a vector and adjustall or adjust n times?)
+    // Acceptance needs a bound on fitness, children raise it as they are placed
+    AcceptanceSelection roulette{fitness_map, 0.0, 0};
     for (int i = 0; i < n; ++i)
-      roulette_map[i] = pop1[i].fit;
+    {
+      double fit = pop1[i].getFitness(fitness_map);
+      roulette.max_fit = std::max(roulette.max_fit, fit);
+      roulette.alive += (fit > 0);
+    }
 
     // Ensure population isn't dead
-    if (roulette_map.GetWeight() == 0)
+    if (roulette.alive == 0 ||
+        !dispatchSteadyState(fitness_map, pop1.data(), steady_scratch.data(), n, batch, m, roulette,
+                             rng, geometric_mutation, boundary))
     {
       std::cout << "Population is dead (pop1), can't evolve!" << std::endl;
       exit(1);
-      return;
     }
+    return;
+  }
 
-    // Select parents
+  // Same tournament size rule and fitness levels as generational tournaments
+  int size = (selection == 't') ? t : 7;
+  bool levels = fitness_map.updateLevels();
+  if (levels && !fitness_map.byte_levels.empty())
+  {
+    TournamentSelection<ByteLevelFitness> tournament{fitness_map, size};
+    dispatchSteadyState(fitness_map, pop1.data(), steady_scratch.data(), n, batch, m, tournament,
+                        rng, geometric_mutation, boundary);
+  }
+  else if (levels)
+  {
+    TournamentSelection<LevelFitness> tournament{fitness_map, size};
+    dispatchSteadyState(fitness_map, pop1.data(), steady_scratch.data(), n, batch, m, tournament,
+                        rng, geometric_mutation, boundary);
+  }
+  else
+  {
+    TournamentSelection<ValueFitness> tournament{fitness_map, size};
+    dispatchSteadyState(fitness_map, pop1.data(), steady_scratch.data(), n, batch, m, tournament,
+                        rng, geometric_mutation, boundary);
+  }
+}
+
+/*
+ * Function to sort the current population by cell, so organisms on the same or nearby cells
+ * (nearby genes, with Morton cells) are stored together. Radix sort on 16 bits at a time, using
+ * the other population array as scratch.
+ * Arguments: None
+ * Returns: Nothing
+ */
+void Population::sortByCell()
+{
+  AlignedArray<Organism> &current = first_pop ? pop1 : pop2;
+  AlignedArray<Organism> &scratch = first_pop ? pop2 : pop1;
+
+  std::vector<uint32_t> offsets(65537);
+  for (int shift = 0; shift < 32; shift += 16)
+  {
+    const AlignedArray<Organism> &from = (shift == 0) ? current : scratch;
+    AlignedArray<Organism> &to = (shift == 0) ? scratch : current;
+
+    // Count each digit, then place organisms after all smaller digits in their current order
+    std::fill(offsets.begin(), offsets.end(), 0);
     for (int i = 0; i < n; ++i)
-    {
-      // Select random parent via roulette style
-      int parent = roulette_map.Index(rng.GetDouble(0, roulette_map.GetWeight())); // Does this do what I expect?
+      ++offsets[((from[i].cell >> shift) & 0xFFFF) + 1];
+    for (int d = 0; d < 65536; ++d)
+      offsets[d + 1] += offsets[d];
+    for (int i = 0; i < n; ++i)
+      to[offsets[(from[i].cell >> shift) & 0xFFFF]++] = from[i];
+  }
+  cells_sorted = true;
+}
 
-      // Create child
-      pop2[i].x = pop1[parent].x;
-      pop2[i].y = pop1[parent].y;
+/*
+ * Function to split the current population into runs of organisms on one cell, as if it were in
+ * cell order. Counted per cell when the map has fewer cells than organisms, else read off a
+ * population that sortByCell put in order.
+ * Arguments: Current population
+ * Returns: True if there are runs, and few enough of them to be worth using
+ */
+bool Population::buildCellRuns(const AlignedArray<Organism> &parents)
+{
+  run_cells.clear();
+  run_ends.clear();
+  if (fitness_map.cells() <= std::size_t(n))
+  {
+    // Count organisms per cell, runs in cell order like a sorted population
+    if (cell_counts.size() != fitness_map.cells())
+      cell_counts = AlignedArray<uint32_t>(fitness_map.cells());
+    for (int i = 0; i < n; ++i)
+      if (cell_counts[parents[i].cell]++ == 0)
+        run_cells.push_back(parents[i].cell);
+    std::sort(run_cells.begin(), run_cells.end());
 
-      // Check if there's a mutation
-      if (rng.P(m))
-        pop2[i].mutate(rng.GetInt(0, 4), xlim, ylim);
-    
-      // Get organism's (new) fitness
-      pop2[i].getFitness(fitness_map);
+    uint32_t total = 0;
+    for (uint32_t cell : run_cells)
+    {
+      total += cell_counts[cell];
+      run_ends.push_back(total);
+      cell_counts[cell] = 0;
     }
   }
-  else
+  else if (cells_sorted)
   {
-    // Calculate the index map (would it be faster to make a vector and adjustall or adjust n times?)
     for (int i = 0; i < n; ++i)
-      roulette_map[i] = pop2[i].fit;
-
-    // Ensure population isn't dead
-    if (roulette_map.GetWeight() == 0)
     {
-      displayFitnessFunction();
-      std::cout << roulette_map[0] << std::endl;
-      std::cout << "Population is dead (pop2), can't evolve!" << std::endl;
-      exit(1);
-      return;
+      if (i > 0 && parents[i].cell != parents[i - 1].cell)
+        run_ends.push_back(i);
+      if (i == 0 || parents[i].cell != parents[i - 1].cell)
+        run_cells.push_back(parents[i].cell);
     }
+    run_ends.push_back(n);
+  }
+
+  if (run_cells.empty() || run_cells.size() * MIN_RUN_LENGTH > std::size_t(n))
+    return false;
 
-    // Select parents
+  run_fitness.resize(run_cells.size());
+  for (std::size_t r = 0; r < run_cells.size(); ++r)
+    run_fitness[r] = fitness_map[run_cells[r]];
+
+  // Random words are split into 2^bits ranges (at least twice the runs), each remembering the
+  // first run its smallest organism can fall in, so a pick scans about one run
+  run_lookup_bits = 1;
+  while (run_lookup_bits < MAX_RUN_LOOKUP_BITS && (std::size_t(1) << run_lookup_bits) < 8 * run_cells.size())
+    ++run_lookup_bits;
+  run_lookup.resize(std::size_t(1) << run_lookup_bits);
+  uint32_t run = 0;
+  for (std::size_t range = 0; range < run_lookup.size(); ++range)
+  {
+    uint32_t organism = uint32_t(((range << (32 - run_lookup_bits)) * n) >> 32);
+    while (run_ends[run] <= organism)
+      ++run;
+    run_lookup[range] = run;
+  }
+  return true;
+}
+
+/*
+ * Function to sort the current population by fitness, with a counting sort over the map's
+ * fitness levels (or a comparison sort if the map has too many distinct values)
+ * Arguments: Current population
+ * Returns: Nothing
+ */
+void Population::rankPopulation(const AlignedArray<Organism> &parents)
+{
+  ranked_cells.resize(n);
+  ranked_group.resize(n);
+
+  if (fitness_map.updateLevels())
+  {
+    // Count organisms per level, then place each level's organisms after all lower levels
+    std::size_t num_levels = fitness_map.level_values.size();
+    group_start.assign(num_levels + 1, 0);
+    for (int i = 0; i < n; ++i)
+      ++group_start[fitness_map.level(parents[i].cell) + 1];
+    for (std::size_t level = 0; level < num_levels; ++level)
+      group_start[level + 1] += group_start[level];
+
+    group_next.assign(group_start.begin(), group_start.end() - 1);
     for (int i = 0; i < n; ++i)
     {
-      // Select random parent via roulette style
-      int parent = roulette_map.Index(rng.GetDouble(0, roulette_map.GetWeight())); // Does this do what I expect?
+      uint16_t level = fitness_map.level(parents[i].cell);
+      uint32_t rank = group_next[level]++;
+      ranked_cells[rank] = parents[i].cell;
+      ranked_group[rank] = level;
+    }
+    return;
+  }
 
-      // Create child
-      pop1[i].x = pop2[parent].x;
-      pop1[i].y = pop2[parent].y;
+  for (int i = 0; i < n; ++i)
+    ranked_cells[i] = parents[i].cell;
+  std::sort(ranked_cells.begin(), ranked_cells.end(),
+            [this](uint32_t a, uint32_t b) { return fitness_map[a] < fitness_map[b]; });
 
-      // Check if there's a mutation
-      if (rng.P(m))
-        pop1[i].mutate(rng.GetInt(0, 4), xlim, ylim);
-    
-      // Get organism's (new) fitness
-      pop1[i].getFitness(fitness_map);
-    }
+  // Number runs of equal fitness
+  group_start.clear();
+  for (int rank = 0; rank < n; ++rank)
+  {
+    if (rank == 0 || fitness_map[ranked_cells[rank]] != fitness_map[ranked_cells[rank - 1]])
+      group_start.push_back(rank);
+    ranked_group[rank] = group_start.size() - 1;
   }
+  group_start.push_back(n);
+}
 
-  // Swap which array is active
-  first_pop = !first_pop;
+/*
+ * Function to apply the landscape schedule steps due this generation. Organisms look their fitness
+ * up in the map every time, so only the map and its fitness levels change.
+ * Arguments: None
+ * Returns: Nothing
+ */
+void Population::applySchedule()
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (schedule.apply(gen, fitness_map))
+    remapOrganisms(old_xlim, old_layout);
+}
+
+/*
+ * Function to change the fitness map size, organisms keep their genes (clamped to the new size)
+ * Arguments: new width, new height
+ * Returns: Nothing
+ */
+void Population::resizeFitnessMap(int xlim, int ylim)
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.resize(xlim, ylim))
+    remapOrganisms(old_xlim, old_layout);
+}
+
+/*
+ * Function to use a procedural landscape instead of a loaded fitness map, organisms keep their genes
+ * Arguments: landscape, width, height, flag to memoize tiles organisms have reached
+ * Returns: Nothing
+ */
+void Population::useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize)
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.setLandscape(landscape, xlim, ylim, memoize))
+    remapOrganisms(old_xlim, old_layout);
+}
+
+/*
+ * Function to change how the fitness map packs cells (Morton keeps nearby genes in nearby memory),
+ * organisms keep their genes
+ * Arguments: cell layout
+ * Returns: Nothing
+ */
+void Population::setCellLayout(CellLayout layout)
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  fitness_map.setLayout(layout);
+  if (fitness_map.layout != old_layout)
+    remapOrganisms(old_xlim, old_layout);
+}
+
+/*
+ * Function to repack organism cells after the fitness map width changed
+ * Arguments: Width and layout the cells were packed with
+ * Returns: Nothing
+ */
+void Population::remapOrganisms(int old_xlim, CellLayout old_layout)
+{
+  auto remap = [this, old_xlim, old_layout](Organism &o)
+  {
+    o.cell = fitness_map.remapCell(o.cell, old_xlim, old_layout);
+  };
+
+  for (int i = 0; i < n; ++i)
+  {
+    remap(init_pop[i]);
+    remap(pop1[i]);
+  }
+  for (std::size_t i = 0; i < pop2.size(); ++i)
+    remap(pop2[i]);
 }
 
 /*
@@ -349,12 +1282,10 @@ void Population::savePopulation(std::string file)
   f << "M " << m << std::endl;
   f << "G " << gen << std::endl;
 
-  if (first_pop)
-    for (int i = 0; i < n; ++i)
-      f << pop1[i].x << " " << pop1[i].y << " " << pop1[i].fit << std::endl;
-  else
-    for (int i = 0; i < n; ++i)
-      f << pop2[i].x << " " << pop2[i].y << " " << pop2[i].fit << std::endl;
+  AlignedArray<Organism> &current = first_pop ? pop1 : pop2;
+  for (int i = 0; i < n; ++i)
+    f << fitness_map.getX(current[i].cell) << " " << fitness_map.getY(current[i].cell) << " "
+      << current[i].getFitness(fitness_map) << std::endl;
 
   f.close();
 }
@@ -373,15 +1304,20 @@ void Population::loadPopulation(std::string file)
   f >> temp >> m;
   f >> temp >> gen;
 
-  if (n > MAX_POP_SIZE)
-  {
-    n = MAX_POP_SIZE;
-    std::cout << "Population size exceeds limit, limiting to " << MAX_POP_SIZE << "!" << std::endl;
-  }
+  // Storage matches the loaded size, the second array is allocated when a generation needs it
+  init_pop.resize(n);
+  pop1.resize(n);
+  pop2.clear();
 
+  // Fitness is looked up from the map, the saved value is skipped
   first_pop = true;
+  int x, y;
+  double fit;
   for (int i = 0; i < n; ++i)
-    f >> pop1[i].x >> pop1[i].y >> pop1[i].fit;
+  {
+    f >> x >> y >> fit;
+    pop1[i].cell = fitness_map.toCell(std::min(x, fitness_map.xlim - 1), std::min(y, fitness_map.ylim - 1));
+  }
 
   f.close();
 }
@@ -393,36 +1329,11 @@ void Population::loadPopulation(std::string file)
  */ 
 void Population::loadFitnessFunction(std::string file)
 {
-  std::ifstream f(file);
-
-  // Get fitness map size
-  double maxfit;
-  double fitspace;
-  f >> xlim >> ylim >> maxfit >> fitspace;
-
-  // If fitness map is larger than allowed
-  if (xlim > MAX_GENE_SIZE || ylim > MAX_GENE_SIZE)
-  {
-    std::cout << "Fitness map exceeds maximum allowed size!" << std::endl;
-    std::cout << xlim << " || " << ylim << " > " << MAX_GENE_SIZE << std::endl;
-    std::cout << "From: " << file << std::endl;
-    return;
-  }
-
-  // Load fitness matrix
-  for (int i = 0; i < ylim; ++i)
-    for (int j = 0; j < xlim; ++j)
-      f >> fitness_map[i][j];
-
-  f.close();
-
-  // Update current population fitness
-  if (first_pop)
-    for (int i = 0; i < n; ++i)
-      pop1[i].getFitness(fitness_map);
-  else
-    for (int i = 0; i < n; ++i)
-      pop2[i].getFitness(fitness_map);
+  // Organism cells depend on the map width, so repack them after loading
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.load(file))
+    remapOrganisms(old_xlim, old_layout);
 }
 
 /*
@@ -432,12 +1343,5 @@ void Population::loadFitnessFunction(std::string file)
  */
 void Population::displayFitnessFunction()
 {
-  for (int i = 0; i < ylim; ++i)
-  {
-    for (int j = 0; j < xlim; ++j)
-    {
-      std::cout << int(fitness_map[i][j]) << " ";
-    }
-       std::cout << std::endl;
-  }
+  fitness_map.display();
 }
@@ -1,29 +1,47 @@
 #ifndef EVOLUTION_H
 #define EVOLUTION_H
 
-#include "emp/base/array.hpp"
 #include "emp/math/Random.hpp"
-#include "emp/datastructs/IndexMap.hpp"
+#include "aligned_array.h"
+#include "alias_table.h"
+#include "fitness_map.h"
+#include "landscape_schedule.h"
+#include "simd_kernels.h"
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
-constexpr int MAX_GENE_SIZE = 100;
-constexpr int MAX_POP_SIZE = 10000;
+constexpr int RNG_BLOCK = 1024; // Children per block of bulk random numbers in batched mode
+constexpr int MIN_RUN_LENGTH = 8; // Cell runs are only used when they average at least this many organisms
+constexpr int MAX_RUN_LOOKUP_BITS = 16; // Largest table from pick to run, 2^16 entries
+constexpr int STEADY_STATE_BATCH = 1024; // Children made before any are placed in steady state mode
+
+// Why evolve stopped
+enum StopReason
+{
+  STOP_NONE = 0, // Ran every generation asked for
+  STOP_MONOMORPHIC = 1, // (Nearly) every organism is on one cell
+  STOP_STABLE = 2, // Occupancy stayed the same over the stable window
+  STOP_TARGET = 3 // An organism reached the target fitness
+};
 
 struct Organism
 {
-  int x; // X gene value
-  int y; // Y gene value
-  double fit; // Fitness value
+  uint32_t cell; // Packed (x, y) genes, index into the fitness map
 
   // Constructors
   Organism();
-  Organism(int x, int y);
+  Organism(uint32_t cell);
 
-  // Function to set fitness from fitness function 
-  void getFitness(emp::array<emp::array<double, MAX_GENE_SIZE>, MAX_GENE_SIZE> &fitness_map);
+  // Function to get fitness from fitness map
+  double getFitness(const FitnessMap &fitness_map) const { return fitness_map[cell]; }
 
   // Function to mutate position in a given direction
-  void mutate(int dir, int xlim, int ylim);
+  void mutate(int dir, const FitnessMap &fitness_map, BoundaryMode boundary = BOUNDARY_CLAMP)
+  {
+    cell = fitness_map.step(cell, dir, boundary);
+  }
 };
 
 struct Population
@@ -31,19 +49,93 @@ struct Population
   int n; // Number of organisms in population
   double m; // Mutation rate
   int gen; // Current generation number
-  int xlim; // Max X gene value
-  int ylim; // Max Y gene value
-  
+
   // Random number generator
   emp::Random rng;
-  
+  uint64_t seed; // Key for the counter-based streams used in parallel mode
+
+  // Parallel generation step, results only depend on seed (not thread count) when enabled
+  bool parallel;
+  int threads; // OpenMP threads for parallel mode, 0 uses the OpenMP default
+
+  // Draw tournament winners from a once per generation fitness ranking, O(1) per child for any size
+  bool ranked_tournament;
+
+  // Rank ('k') and truncation ('c') selection, drawn from the same ranking
+  double rank_pressure; // Expected children of the fittest organism, the least fit expects 2 - this (1 to 2)
+  double truncation_share; // Parents are uniform over this fittest share of the population (0 to 1)
+
+  // Generation loop policies, the serial tournament and roulette loops are specialized for each
+  BoundaryMode boundary; // Where mutations off the map edge go
+  bool geometric_mutation; // Skip to mutated children with geometric gaps instead of a coin per child
+
+  // Draw parent picks in bulk blocks and skip to mutated children with geometric gaps
+  bool batched_rng;
+  SimdLevel simd_level; // Instruction set for batched tournaments, defaults to the widest supported
+
+  // Batched tournaments pick among runs of organisms on one cell (the population in cell order)
+  // instead of single organisms, so picks read small run tables rather than the whole population
+  bool bucket_by_cell;
+  int reorder_interval; // Sort organisms by cell every this many generations, 0 never (needed for runs on maps with more cells than organisms)
+  bool cells_sorted; // Current population is in cell order
+
+  // Steady state mode, n births per generation each replacing a random organism in place. Only pop1
+  // is kept (pop2 is freed) and children wait in a scratch batch. Serial, other modes are ignored.
+  bool steady_state;
+  int steady_batch; // Children per scratch batch, parents of a batch all come from before it
+  AlignedArray<Organism> steady_scratch;
+
+  // Early stopping, rules are checked every check_interval generations (0 never checks)
+  int check_interval;
+  double monomorphic_share; // Stop once this share of organisms is on one cell, 1 for every organism (0 off)
+  int stable_window; // Stop once occupancy has stayed the same for this many generations (0 off)
+  double stable_tolerance; // Share of organisms that may have moved for occupancy to count as the same
+  double target_fitness; // Stop once an organism is this fit (infinity off)
+  StopReason stop_reason; // Why the last evolve stopped
+  int stable_since; // Generation the stable histogram was taken
+  std::vector<std::pair<uint32_t, uint32_t>> stable_histogram; // (cell, organisms) when occupancy last changed
+
+  // Jump over generations where the population can't change (every parent on one cell) by drawing
+  // the wait for the next mutant that can, then drawing that generation exactly. With a
+  // monomorphic_share between 0 and 1, a cell holding that share with the rest on neighbors selected
+  // against also counts (an approximation, see fastForward). Not used while saving every generation
+  // or in steady state mode.
+  bool fast_forward;
+  int skipped_generations; // Generations the last evolve jumped over
+
+  // Fitness map changes applied during evolve at the generations they are scheduled for
+  LandscapeSchedule schedule;
+
   // Organism and fitness value storage
   bool first_pop; // Using pop1 if true, else pop2 is current
-  emp::array<Organism, MAX_POP_SIZE> init_pop; // Initial population, used for resetting
-  emp::array<Organism, MAX_POP_SIZE> pop1;
-  emp::array<Organism, MAX_POP_SIZE> pop2;
-  emp::array<emp::array<double, MAX_GENE_SIZE>, MAX_GENE_SIZE> fitness_map;
-  emp::IndexMap roulette_map;
+  AlignedArray<Organism> init_pop; // Initial population, used for resetting
+  AlignedArray<Organism> pop1;
+  AlignedArray<Organism> pop2; // Allocated on demand, empty after steady state generations
+  FitnessMap fitness_map;
+
+  // Roulette wheel, rebuilt each generation over organisms or (if fewer) occupied cells. Stochastic
+  // universal sampling walks the same weights instead of building the table.
+  AliasTable roulette_table;
+  bool roulette_by_cell; // Table slots are roulette_cells entries instead of organisms
+  std::vector<uint32_t> roulette_cells; // Occupied cells, when building by cell
+  std::vector<double> roulette_weights; // Weight of each table slot
+  AlignedArray<uint32_t> cell_counts; // Organisms per cell, all 0 between generations
+
+  // Fitness of each parent, gathered once per generation for batched tournaments
+  AlignedArray<double> parent_fitness;
+
+  // Cell runs, rebuilt each generation for bucketed tournaments
+  std::vector<uint32_t> run_cells; // Cell of each run
+  AlignedArray<double> run_fitness; // Fitness of each run's cell
+  std::vector<uint32_t> run_ends; // Organisms in this run and all before it
+  std::vector<uint32_t> run_lookup; // First run reaching each range of random words
+  int run_lookup_bits;
+
+  // Fitness ranking, rebuilt each generation for ranked tournaments, rank and truncation selection
+  AlignedArray<uint32_t> ranked_cells; // Current population's cells in increasing fitness order
+  AlignedArray<uint32_t> ranked_group; // Tie group (equal fitness) of each rank
+  std::vector<uint32_t> group_start; // First rank of each tie group, followed by n
+  std::vector<uint32_t> group_next; // Next free rank of each group while counting sort places organisms
 
   // Population constructor
   Population(int n = 10000,
@@ -51,24 +143,62 @@ struct Population
              int xstart = 0,
              int ystart = 0);
 
-  // Main simulation
-  void evolve(int generations = 100,
-              char selection = 't',
-              int tournament_size = 7,
-              bool save_all = false,
-              std::string save_dir = "./TestData");
+  // Main simulation, returns the generation it stopped at
+  int evolve(int generations = 100,
+             char selection = 't',
+             int tournament_size = 7,
+             bool save_all = false,
+             std::string save_dir = "./TestData");
+  void nextGeneration(char selection, int tournament_size);
+  int fastForward(char selection, int remaining);
+  bool converged();
+  std::vector<std::pair<uint32_t, uint32_t>> occupancy() const;
   void newInitPop();
   void reset();
-  
+  void resize(int n);
+  void setSeed(int seed);
+
   // Parent selection methods
   void selectionTournament(int t);
   void selectionRoulette();
+  void selectionUniversal();
+  void selectionTournamentParallel(int t);
+  void selectionRouletteParallel();
+  void selectionTournamentRanked(int t);
+  void selectionLinearRank();
+  void selectionTruncation();
+  template <typename Rank>
+  void selectionByRank(const Rank &rank);
+  void selectionBatched(char selection, int t);
+  void selectionSteadyState(char selection, int t);
+  double buildRouletteWeights(const AlignedArray<Organism> &parents);
+  double buildRouletteTable(const AlignedArray<Organism> &parents);
+  void sortByCell();
+  bool buildCellRuns(const AlignedArray<Organism> &parents);
+  uint32_t runOfWord(uint32_t word) const
+  {
+    // Word maps to organism (word * n) >> 32 like other batched picks, then to the run holding it
+    uint32_t organism = uint32_t((uint64_t(word) * n) >> 32);
+    uint32_t run = run_lookup[word >> (32 - run_lookup_bits)];
+    run += (run_ends[run] <= organism); // Usually the only step, taken without a branch
+    while (run_ends[run] <= organism)
+      ++run;
+    return run;
+  }
+  void rankPopulation(const AlignedArray<Organism> &parents);
+
+  // Fitness map changes, keeps organisms on the same genes
+  void applySchedule();
+  void resizeFitnessMap(int xlim, int ylim);
+  void useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize = false);
+  void setCellLayout(CellLayout layout);
+  void remapOrganisms(int old_xlim, CellLayout old_layout);
 
   // File IO
   void savePopulation(std::string file);
   void loadPopulation(std::string file);
   void loadFitnessFunction(std::string file);
-  
+
   // Display functions
   void displayFitnessFunction();
 };
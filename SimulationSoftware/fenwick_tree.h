@@ -0,0 +1,71 @@
+#ifndef FENWICK_TREE_H
+#define FENWICK_TREE_H
+
+#include <cstddef>
+#include <vector>
+
+// Fenwick (binary indexed) tree over k weights: O(k) to build, O(log k) to change one weight or to
+// draw a slot in proportion to the weights
+template <typename T>
+class FenwickTree
+{
+private:
+  std::vector<T> tree; // tree[i] sums the weights of slots i - lowbit(i) to i - 1, tree[0] is unused
+  std::size_t top; // Largest power of 2 <= k, where searches start
+
+public:
+  FenwickTree() : top(0) {}
+
+  // Build from k weights
+  void build(const T *weights, std::size_t k)
+  {
+    tree.assign(k + 1, T());
+    for (std::size_t i = 1; i <= k; ++i)
+      tree[i] = weights[i - 1];
+    for (std::size_t i = 1; i <= k; ++i)
+    {
+      std::size_t parent = i + (i & (~i + 1));
+      if (parent <= k)
+        tree[parent] += tree[i];
+    }
+    for (top = 1; top * 2 <= k; top *= 2);
+  }
+
+  std::size_t size() const { return tree.empty() ? 0 : tree.size() - 1; }
+
+  // Change the weight of a slot by delta
+  void add(std::size_t slot, T delta)
+  {
+    for (std::size_t i = slot + 1; i < tree.size(); i += i & (~i + 1))
+      tree[i] += delta;
+  }
+
+  // Sum of the weights of slots before end
+  T prefix(std::size_t end) const
+  {
+    T sum = T();
+    for (std::size_t i = end; i > 0; i -= i & (~i + 1))
+      sum += tree[i];
+    return sum;
+  }
+
+  T total() const { return prefix(size()); }
+
+  // Slot holding a point of the weight line, the first whose running total passes target
+  // (target in [0, total), so each slot is found in proportion to its weight)
+  std::size_t find(T target) const
+  {
+    std::size_t pos = 0;
+    for (std::size_t step = top; step > 0; step /= 2)
+    {
+      if (pos + step < tree.size() && tree[pos + step] <= target)
+      {
+        pos += step;
+        target -= tree[pos];
+      }
+    }
+    return (pos < size()) ? pos : size() - 1;
+  }
+};
+
+#endif
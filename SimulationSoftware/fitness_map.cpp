@@ -0,0 +1,861 @@
+#include "fitness_map.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <limits>
+
+/*
+ * Constructs an all 0 fitness map
+ * Arguments: map width, map height
+ * Returns: FitnessMap
+ */
+FitnessMap::FitnessMap(int xlim, int ylim) :
+  xlim(xlim),
+  ylim(ylim),
+  layout(defaultLayout(xlim, ylim)),
+  memoize(false),
+  levels_dirty(true)
+{
+  allocate(defaultStorage(xlim, ylim));
+  buildNeighborTable();
+}
+
+/*
+ * Function to get the fitness of a gene pair
+ * Arguments: x gene, y gene
+ * Returns: Fitness value
+ */
+double FitnessMap::get(int x, int y) const
+{
+  if (storage == STORAGE_DENSE)
+    return fitness[toCell(x, y)];
+  if (storage == STORAGE_PALETTE)
+    return level_values[level(toCell(x, y))];
+  if (storage == STORAGE_TILED)
+    return tiledValue(x, y);
+  return proceduralValue(x, y);
+}
+
+/*
+ * Function to set the fitness of a gene pair
+ * Arguments: x gene, y gene, fitness value
+ * Returns: Nothing
+ */
+void FitnessMap::set(int x, int y, double value)
+{
+  // Landscapes are read only, editing one turns it into stored values first
+  if (storage == STORAGE_PROCEDURAL)
+    setStorage(defaultStorage(xlim, ylim));
+
+  if (storage == STORAGE_DENSE)
+  {
+    uint32_t cell = toCell(x, y);
+    if (fitness[cell] == value)
+      return;
+    fitness[cell] = value;
+
+    // Current levels take the value in place (see levelFor), so an edit doesn't renumber the map.
+    // Maps with too many values for levels stay without them instead of being rebuilt every edit.
+    if (!levels_dirty)
+    {
+      std::size_t new_level;
+      if (levels.empty())
+        return;
+      if (levelFor(value, new_level))
+      {
+        levels[cell] = new_level;
+        return;
+      }
+    }
+  }
+  else if (storage == STORAGE_PALETTE)
+  {
+    // New values get a level of their own in value order, too many go back to stored values
+    std::size_t new_level;
+    if (!levelFor(value, new_level))
+    {
+      setStorage(defaultStorage(xlim, ylim));
+      set(x, y, value);
+      return;
+    }
+    setLevel(toCell(x, y), new_level);
+    return;
+  }
+  else
+  {
+    // Uniform tiles only get stored once a cell differs
+    std::size_t tile = tileIndex(x, y);
+    if (tile_slot[tile] == UNIFORM_TILE && tile_value[tile] == value)
+      return;
+    storeTile(x, y)[tileOffset(x, y)] = value;
+  }
+  levels_dirty = true;
+}
+
+/*
+ * Function to compute the cell reached by a mutation without the neighbor table
+ * Arguments: cell, mutation direction
+ * Returns: Neighboring cell (same cell at the map edge)
+ */
+uint32_t FitnessMap::computeNeighbor(uint32_t cell, int dir) const
+{
+  if (layout == LAYOUT_MORTON)
+    return mortonNeighbor(cell, dir);
+
+  int x = getX(cell);
+  int y = getY(cell);
+  switch(dir)
+  {
+  case X_INCREASE:
+    return (x < xlim - 1) ? toCell(x + 1, y) : cell;
+  case X_DECREASE:
+    return (x > 0) ? toCell(x - 1, y) : cell;
+  case Y_INCREASE:
+    return (y < ylim - 1) ? toCell(x, y + 1) : cell;
+  case Y_DECREASE:
+    return (y > 0) ? toCell(x, y - 1) : cell;
+  default:
+    return cell;
+  }
+}
+
+/*
+ * Function to compute the cell reached by a mutation on a Morton map, stepping one gene's bits
+ * without unpacking (the other gene's bits are set so carries pass through them)
+ * Arguments: cell, mutation direction
+ * Returns: Neighboring cell (same cell at the map edge)
+ */
+uint32_t FitnessMap::mortonNeighbor(uint32_t cell, int dir) const
+{
+  uint32_t x = cell & MORTON_X_BITS;
+  uint32_t y = cell & MORTON_Y_BITS;
+  switch(dir)
+  {
+  case X_INCREASE:
+    return (x < morton_xmax) ? (((x | MORTON_Y_BITS) + 1) & MORTON_X_BITS) | y : cell;
+  case X_DECREASE:
+    return (x > 0) ? ((x - 1) & MORTON_X_BITS) | y : cell;
+  case Y_INCREASE:
+    return (y < morton_ymax) ? (((y | MORTON_X_BITS) + 1) & MORTON_Y_BITS) | x : cell;
+  case Y_DECREASE:
+    return (y > 0) ? ((y - 1) & MORTON_Y_BITS) | x : cell;
+  default:
+    return cell;
+  }
+}
+
+/*
+ * Function to compute the cell reached by a mutation on a map that wraps around at the edges
+ * Arguments: cell, mutation direction
+ * Returns: Neighboring cell (opposite edge when leaving the map)
+ */
+uint32_t FitnessMap::wrapNeighbor(uint32_t cell, int dir) const
+{
+  int x = getX(cell);
+  int y = getY(cell);
+  switch(dir)
+  {
+  case X_INCREASE:
+    return toCell((x < xlim - 1) ? x + 1 : 0, y);
+  case X_DECREASE:
+    return toCell((x > 0) ? x - 1 : xlim - 1, y);
+  case Y_INCREASE:
+    return toCell(x, (y < ylim - 1) ? y + 1 : 0);
+  case Y_DECREASE:
+    return toCell(x, (y > 0) ? y - 1 : ylim - 1);
+  default:
+    return cell;
+  }
+}
+
+/*
+ * Function to compute the cell reached by a mutation on a map that reflects at the edges
+ * Arguments: cell, mutation direction
+ * Returns: Neighboring cell (one cell back inside when leaving the map)
+ */
+uint32_t FitnessMap::reflectNeighbor(uint32_t cell, int dir) const
+{
+  int x = getX(cell);
+  int y = getY(cell);
+  switch(dir)
+  {
+  case X_INCREASE:
+    return (x < xlim - 1) ? toCell(x + 1, y) : ((x > 0) ? toCell(x - 1, y) : cell);
+  case X_DECREASE:
+    return (x > 0) ? toCell(x - 1, y) : ((x < xlim - 1) ? toCell(x + 1, y) : cell);
+  case Y_INCREASE:
+    return (y < ylim - 1) ? toCell(x, y + 1) : ((y > 0) ? toCell(x, y - 1) : cell);
+  case Y_DECREASE:
+    return (y > 0) ? toCell(x, y - 1) : ((y < ylim - 1) ? toCell(x, y + 1) : cell);
+  default:
+    return cell;
+  }
+}
+
+/*
+ * Function to check if a map size can be stored (cells are packed into 32 bits)
+ * Arguments: width, height
+ * Returns: True if the size is allowed
+ */
+bool FitnessMap::validSize(int xlim, int ylim)
+{
+  return xlim > 0 && ylim > 0 && uint64_t(xlim) * uint64_t(ylim) <= MAX_CELLS;
+}
+
+/*
+ * Function to change the size of the map, new cells are set to 0
+ * Arguments: new width, new height
+ * Returns: True if the size is allowed
+ */
+bool FitnessMap::resize(int new_xlim, int new_ylim)
+{
+  if (!validSize(new_xlim, new_ylim))
+  {
+    std::cout << "Fitness map size " << new_xlim << "x" << new_ylim << " is not allowed!" << std::endl;
+    return false;
+  }
+
+  // Landscapes are evaluated at any size, only the memoized tiles are dropped
+  if (storage == STORAGE_PROCEDURAL)
+  {
+    xlim = new_xlim;
+    ylim = new_ylim;
+    if (layout != LAYOUT_MORTON || std::max(xlim, ylim) > MAX_MORTON_SIDE)
+      layout = defaultLayout(xlim, ylim);
+    allocate(STORAGE_PROCEDURAL);
+    buildNeighborTable();
+    return true;
+  }
+
+  // Cell stride changes with xlim, so repack into new storage (tiled and Morton maps stay so)
+  FitnessMap old(std::move(*this));
+  xlim = new_xlim;
+  ylim = new_ylim;
+  layout = (old.layout == LAYOUT_MORTON && std::max(xlim, ylim) <= MAX_MORTON_SIDE) ? LAYOUT_MORTON : defaultLayout(xlim, ylim);
+  bool tiled = (old.storage == STORAGE_TILED || defaultStorage(xlim, ylim) == STORAGE_TILED);
+  allocate(tiled ? STORAGE_TILED : old.storage);
+  copyCells(old);
+  levels_dirty = true;
+  buildNeighborTable();
+  return true;
+}
+
+/*
+ * Function to precompute the cell reached by each mutation direction
+ * Arguments: None
+ * Returns: Nothing
+ */
+void FitnessMap::buildNeighborTable()
+{
+  // Table takes 16 bytes per cell, huge maps use computeNeighbor instead
+  if (cells() > MAX_NEIGHBOR_TABLE_CELLS)
+  {
+    neighbors.clear();
+    return;
+  }
+
+  neighbors.resize(NUM_DIRECTIONS * cells());
+  for (int y = 0; y < ylim; ++y)
+  {
+    for (int x = 0; x < xlim; ++x)
+    {
+      uint32_t cell = toCell(x, y);
+      uint32_t *n = &neighbors[NUM_DIRECTIONS * std::size_t(cell)];
+      n[X_INCREASE] = (x < xlim - 1) ? toCell(x + 1, y) : cell;
+      n[X_DECREASE] = (x > 0) ? toCell(x - 1, y) : cell;
+      n[Y_INCREASE] = (y < ylim - 1) ? toCell(x, y + 1) : cell;
+      n[Y_DECREASE] = (y > 0) ? toCell(x, y - 1) : cell;
+    }
+  }
+}
+
+/*
+ * Function to pick how a map of a given size packs its cells
+ * Arguments: width, height
+ * Returns: Morton for maps too big for cache whose square padding at most doubles the cells, else row-major
+ */
+CellLayout FitnessMap::defaultLayout(int xlim, int ylim)
+{
+  std::size_t side = 1;
+  while (side < std::size_t(std::max(xlim, ylim)))
+    side *= 2;
+
+  std::size_t cells = std::size_t(xlim) * ylim;
+  return (cells >= MIN_MORTON_CELLS && side * side <= 2 * cells) ? LAYOUT_MORTON : LAYOUT_ROW_MAJOR;
+}
+
+/*
+ * Function to change how cells are packed, values are kept. Cell numbers change, so organisms
+ * have to be remapped (Population::setCellLayout does both).
+ * Arguments: cell layout
+ * Returns: Nothing
+ */
+void FitnessMap::setLayout(CellLayout new_layout)
+{
+  if (new_layout == layout)
+    return;
+
+  if (new_layout == LAYOUT_MORTON && std::max(xlim, ylim) > MAX_MORTON_SIDE)
+  {
+    std::cout << "Fitness map size " << xlim << "x" << ylim << " is too big for Morton cells!" << std::endl;
+    return;
+  }
+
+  FitnessMap old(std::move(*this));
+  layout = new_layout;
+  allocate(old.storage);
+  if (storage != STORAGE_PROCEDURAL)
+    copyCells(old);
+  buildNeighborTable();
+}
+
+/*
+ * Function to pick how a map of a given size is stored
+ * Arguments: width, height
+ * Returns: Dense for maps up to MAX_DENSE_CELLS, else tiled
+ */
+FitnessStorage FitnessMap::defaultStorage(int xlim, int ylim)
+{
+  return (std::size_t(xlim) * ylim > MAX_DENSE_CELLS) ? STORAGE_TILED : STORAGE_DENSE;
+}
+
+/*
+ * Function to set up all 0 storage for the current size
+ * Arguments: storage layout
+ * Returns: Nothing
+ */
+void FitnessMap::allocate(FitnessStorage new_storage)
+{
+  morton_side = 0;
+  if (layout == LAYOUT_MORTON)
+    for (morton_side = 1; morton_side < std::max(xlim, ylim); morton_side *= 2);
+  morton_xmax = spreadBits(xlim - 1);
+  morton_ymax = spreadBits(ylim - 1) << 1;
+
+  storage = new_storage;
+  tiles_x = (xlim + TILE_SIZE - 1) >> TILE_BITS;
+  tiles_y = (ylim + TILE_SIZE - 1) >> TILE_BITS;
+  std::vector<double>().swap(tile_data);
+
+  byte_levels.clear();
+  if (storage == STORAGE_DENSE)
+  {
+    fitness = AlignedArray<double>(cells());
+    tile_slot.clear();
+    tile_value.clear();
+  }
+  else if (storage == STORAGE_PALETTE)
+  {
+    // Every cell starts on the single level, 0
+    fitness.clear();
+    tile_slot.clear();
+    tile_value.clear();
+    level_values.assign(1, 0.0);
+    levels.clear();
+    byte_levels = AlignedArray<uint8_t>(cells());
+  }
+  else if (storage == STORAGE_PROCEDURAL && !memoize)
+  {
+    fitness.clear();
+    tile_slot.clear();
+    tile_value.clear();
+  }
+  else
+  {
+    // Procedural maps use the directory to find memoized tiles, uniform ones are not yet filled
+    fitness.clear();
+    // Morton tiles are numbered over the whole padded square
+    std::size_t tiles = std::size_t(tiles_x) * tiles_y;
+    if (layout == LAYOUT_MORTON)
+      tiles = std::max(cells() >> (2 * TILE_BITS), std::size_t(1));
+    tile_slot = AlignedArray<uint32_t>(tiles);
+    tile_slot.fill(UNIFORM_TILE);
+    tile_value = AlignedArray<double>(tiles);
+  }
+  levels_dirty = true;
+}
+
+/*
+ * Function to convert the map to another storage layout, values are kept
+ * Arguments: storage layout
+ * Returns: Nothing
+ */
+void FitnessMap::setStorage(FitnessStorage new_storage)
+{
+  // Landscapes only come from setLandscape
+  if (new_storage == storage || new_storage == STORAGE_PROCEDURAL)
+    return;
+
+  FitnessMap old(std::move(*this));
+  allocate(new_storage);
+  copyCells(old);
+  buildNeighborTable();
+}
+
+/*
+ * Function to copy the values of another map into this one's storage, for cells inside both
+ * Arguments: map to copy from
+ * Returns: Nothing
+ */
+void FitnessMap::copyCells(const FitnessMap &old)
+{
+  int rows = std::min(ylim, old.ylim);
+  int cols = std::min(xlim, old.xlim);
+
+  // Palettes are built in one pass rather than a level at a time
+  if (storage == STORAGE_PALETTE && !buildPalette(old))
+  {
+    std::cout << "Fitness map has more than " << MAX_FITNESS_LEVELS << " values, can't use a palette!" << std::endl;
+    allocate(defaultStorage(xlim, ylim));
+  }
+
+  if (storage == STORAGE_PALETTE)
+  {
+    for (int y = 0; y < rows; ++y)
+      for (int x = 0; x < cols; ++x)
+        setLevel(toCell(x, y), std::lower_bound(level_values.begin(), level_values.end(), old.get(x, y)) - level_values.begin());
+    return;
+  }
+
+  for (int y = 0; y < rows; ++y)
+    for (int x = 0; x < cols; ++x)
+      set(x, y, old.get(x, y));
+
+  if (storage == STORAGE_TILED)
+    compactTiles();
+}
+
+/*
+ * Function to set up the level table of a palette map for the values of another map (new cells
+ * are 0, so 0 is always included)
+ * Arguments: map to take values from
+ * Returns: False if there are too many distinct values
+ */
+bool FitnessMap::buildPalette(const FitnessMap &old)
+{
+  std::vector<double> values(1, 0.0);
+  if (old.storage == STORAGE_PALETTE)
+  {
+    values.insert(values.end(), old.level_values.begin(), old.level_values.end());
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+  }
+  else
+  {
+    // Keep the distinct values sorted as they are found, memory stays at one entry per value
+    for (int y = 0; y < std::min(ylim, old.ylim); ++y)
+    {
+      for (int x = 0; x < std::min(xlim, old.xlim); ++x)
+      {
+        double value = old.get(x, y);
+        auto place = std::lower_bound(values.begin(), values.end(), value);
+        if (place != values.end() && *place == value)
+          continue;
+        if (values.size() == MAX_FITNESS_LEVELS)
+          return false;
+        values.insert(place, value);
+      }
+    }
+  }
+
+  level_values.swap(values);
+  if (level_values.size() > MAX_BYTE_LEVELS)
+  {
+    byte_levels.clear();
+    levels = AlignedArray<uint16_t>(cells());
+  }
+  return true;
+}
+
+/*
+ * Function to find the level of a value, giving it one if it has none. A new value takes a spare
+ * level between its neighbors or past the top of the table, so no cell is renumbered; only when
+ * there is no spare level are the levels spread out again.
+ * Arguments: value, level of the value (output)
+ * Returns: False if there are too many distinct values for a level table
+ */
+bool FitnessMap::levelFor(double value, std::size_t &new_level)
+{
+  std::size_t above = std::lower_bound(level_values.begin(), level_values.end(), value) - level_values.begin();
+  if (above < level_values.size() && level_values[above] == value)
+  {
+    new_level = above;
+    return true;
+  }
+
+  // Values above every level go on top while the table has room
+  if (above == level_values.size() && above < levelCapacity())
+  {
+    level_values.push_back(value);
+    new_level = above;
+    return true;
+  }
+
+  // The spare levels of the value below are split, the upper half repeats the new value instead
+  if (above > 0)
+  {
+    std::size_t below = std::lower_bound(level_values.begin(), level_values.begin() + above, level_values[above - 1]) - level_values.begin();
+    std::size_t spare = above - 1 - below;
+    if (spare > 0)
+    {
+      new_level = below + 1 + spare / 2;
+      std::fill(level_values.begin() + new_level, level_values.begin() + above, value);
+      return true;
+    }
+  }
+
+  if (!spreadLevels(value))
+    return false;
+  new_level = std::lower_bound(level_values.begin(), level_values.end(), value) - level_values.begin();
+  return true;
+}
+
+/*
+ * Function to spread the levels out so each value is followed by spare levels, dropping values no
+ * cell holds and adding a new one. Every cell is renumbered, which the spare levels make rare.
+ * Arguments: value to add
+ * Returns: False if there are too many distinct values for a level table (levels are unchanged)
+ */
+bool FitnessMap::spreadLevels(double value)
+{
+  // Values some cell is on, Morton padding cells are skipped as they never hold organisms
+  std::vector<char> used(level_values.size(), 0);
+  for (int y = 0; y < ylim; ++y)
+    for (int x = 0; x < xlim; ++x)
+      used[level(toCell(x, y))] = 1;
+
+  std::vector<double> values;
+  for (std::size_t l = 0; l < level_values.size(); ++l)
+    if (used[l])
+      values.push_back(level_values[l]);
+  values.insert(std::lower_bound(values.begin(), values.end(), value), value);
+  if (values.size() > MAX_FITNESS_LEVELS)
+    return false;
+
+  // Byte levels without room for spares between the values move to 2 bytes
+  if (!byte_levels.empty() && values.size() * MIN_BYTE_LEVEL_GAP > MAX_BYTE_LEVELS)
+  {
+    levels = AlignedArray<uint16_t>(cells());
+    for (int y = 0; y < ylim; ++y)
+      for (int x = 0; x < xlim; ++x)
+        levels[toCell(x, y)] = byte_levels[toCell(x, y)];
+    byte_levels.clear();
+  }
+
+  // Each value gets gap levels, after a run of -infinity so values below the lowest have room too
+  std::size_t capacity = levelCapacity();
+  std::size_t gap = std::max<std::size_t>(1, std::min(LEVEL_GAP, capacity / (values.size() + 1)));
+  std::size_t front = ((values.size() + 1) * gap <= capacity && values[0] != -std::numeric_limits<double>::infinity()) ? gap : 0;
+  std::vector<double> spread(front, -std::numeric_limits<double>::infinity());
+  for (double v : values)
+    spread.insert(spread.end(), gap, v);
+
+  std::vector<uint32_t> renumber(level_values.size());
+  for (std::size_t l = 0; l < level_values.size(); ++l)
+    if (used[l])
+      renumber[l] = front + (std::lower_bound(values.begin(), values.end(), level_values[l]) - values.begin()) * gap;
+  for (int y = 0; y < ylim; ++y)
+    for (int x = 0; x < xlim; ++x)
+      setLevel(toCell(x, y), renumber[level(toCell(x, y))]);
+
+  level_values.swap(spread);
+  return true;
+}
+
+/*
+ * Function to get the stored values of the tile holding a cell, storing it first if uniform
+ * Arguments: x gene, y gene
+ * Returns: Pointer to the tile's TILE_CELLS values
+ */
+double *FitnessMap::storeTile(int x, int y)
+{
+  std::size_t tile = tileIndex(x, y);
+  if (tile_slot[tile] == UNIFORM_TILE)
+  {
+    tile_slot[tile] = tile_data.size() / TILE_CELLS;
+    tile_data.resize(tile_data.size() + TILE_CELLS, tile_value[tile]);
+  }
+  return &tile_data[tile_slot[tile] * TILE_CELLS];
+}
+
+/*
+ * Function to turn stored tiles whose cells all have one value back into uniform tiles
+ * Arguments: None
+ * Returns: Nothing
+ */
+void FitnessMap::compactTiles()
+{
+  std::vector<double> kept;
+  for (int ty = 0; ty < tiles_y; ++ty)
+  {
+    for (int tx = 0; tx < tiles_x; ++tx)
+    {
+      std::size_t tile = tileAt(tx, ty);
+      if (tile_slot[tile] == UNIFORM_TILE)
+        continue;
+
+      // Only cells inside the map count, edge tiles are partly unused
+      const double *data = &tile_data[tile_slot[tile] * TILE_CELLS];
+      int rows = std::min(TILE_SIZE, ylim - ty * TILE_SIZE);
+      int cols = std::min(TILE_SIZE, xlim - tx * TILE_SIZE);
+      bool uniform = true;
+      for (int i = 0; i < rows && uniform; ++i)
+        for (int j = 0; j < cols && uniform; ++j)
+          uniform = (data[cellInTile(i, j)] == data[0]);
+
+      if (uniform)
+      {
+        tile_slot[tile] = UNIFORM_TILE;
+        tile_value[tile] = data[0];
+      }
+      else
+      {
+        tile_slot[tile] = kept.size() / TILE_CELLS;
+        kept.insert(kept.end(), data, data + TILE_CELLS);
+      }
+    }
+  }
+  tile_data.swap(kept);
+}
+
+/*
+ * Function to make the map a procedural landscape, nothing is stored unless memoizing
+ * Arguments: landscape, width, height, flag to memoize tiles organisms have reached
+ * Returns: True if the size is allowed
+ */
+bool FitnessMap::setLandscape(const Landscape &new_landscape, int new_xlim, int new_ylim, bool memoize_tiles)
+{
+  if (!validSize(new_xlim, new_ylim))
+  {
+    std::cout << "Fitness map size " << new_xlim << "x" << new_ylim << " is not allowed!" << std::endl;
+    return false;
+  }
+
+  xlim = new_xlim;
+  ylim = new_ylim;
+  layout = defaultLayout(xlim, ylim);
+  landscape = new_landscape;
+  memoize = memoize_tiles;
+  allocate(STORAGE_PROCEDURAL);
+  buildNeighborTable();
+  return true;
+}
+
+/*
+ * Function to fill the memoized tile holding a cell from the landscape, if it isn't yet
+ * Arguments: cell
+ * Returns: Nothing
+ */
+void FitnessMap::memoizeCell(uint32_t cell)
+{
+  if (storage != STORAGE_PROCEDURAL || tile_slot.empty())
+    return;
+
+  int x = getX(cell);
+  int y = getY(cell);
+  if (tile_slot[tileIndex(x, y)] != UNIFORM_TILE)
+    return;
+
+  int x0 = x & ~(TILE_SIZE - 1);
+  int y0 = y & ~(TILE_SIZE - 1);
+  double *tile = storeTile(x, y);
+  int rows = std::min(TILE_SIZE, ylim - y0);
+  int cols = std::min(TILE_SIZE, xlim - x0);
+  for (int i = 0; i < rows; ++i)
+    for (int j = 0; j < cols; ++j)
+      tile[cellInTile(i, j)] = landscape.value(x0 + j, y0 + i);
+}
+
+/*
+ * Function to get the memory used by the fitness values
+ * Arguments: None
+ * Returns: Bytes
+ */
+std::size_t FitnessMap::storageBytes() const
+{
+  std::size_t bytes = fitness.bytes() + tile_slot.bytes() + tile_value.bytes() + tile_data.capacity() * sizeof(double);
+  if (storage == STORAGE_PALETTE)
+    bytes += levels.bytes() + byte_levels.bytes() + level_values.capacity() * sizeof(double);
+  return bytes;
+}
+
+/*
+ * Function to number the distinct fitness values in increasing order
+ * Arguments: None
+ * Returns: True if every cell has a level
+ */
+bool FitnessMap::updateLevels()
+{
+  // Palette maps are stored as levels, so they are always current
+  if (storage == STORAGE_PALETTE)
+    return true;
+
+  if (!levels_dirty)
+    return !levels.empty();
+  levels_dirty = false;
+
+  // Levels take 2 bytes per cell and evaluating every cell, which tiled and procedural maps are
+  // meant to avoid (their tournaments compare values)
+  if (storage == STORAGE_TILED || storage == STORAGE_PROCEDURAL || cells() > MAX_DENSE_CELLS)
+  {
+    level_values.clear();
+    levels.clear();
+    return false;
+  }
+
+  // Morton padding cells are skipped, they never hold organisms
+  level_values.resize(std::size_t(xlim) * ylim);
+  for (int y = 0; y < ylim; ++y)
+    for (int x = 0; x < xlim; ++x)
+      level_values[std::size_t(y) * xlim + x] = get(x, y);
+  std::sort(level_values.begin(), level_values.end());
+  level_values.erase(std::unique(level_values.begin(), level_values.end()), level_values.end());
+
+  if (level_values.size() > MAX_FITNESS_LEVELS)
+  {
+    level_values.clear();
+    levels.clear();
+    return false;
+  }
+
+  levels.resize(cells());
+  for (int y = 0; y < ylim; ++y)
+    for (int x = 0; x < xlim; ++x)
+      levels[toCell(x, y)] = std::lower_bound(level_values.begin(), level_values.end(), get(x, y)) - level_values.begin();
+  return true;
+}
+
+/*
+ * Function to load a fitness map from file (2D array)
+ * Arguments: Filepath/name to load from
+ * Returns: True if the map was loaded
+ */
+bool FitnessMap::load(std::string file)
+{
+  std::ifstream f(file);
+
+  // Get fitness map size
+  int new_xlim = 0;
+  int new_ylim = 0;
+  double maxfit;
+  double fitspace;
+  f >> new_xlim >> new_ylim >> maxfit >> fitspace;
+
+  // If fitness map can't be stored
+  if (!f || !validSize(new_xlim, new_ylim))
+  {
+    std::cout << "Fitness map is missing or has an invalid size!" << std::endl;
+    std::cout << new_xlim << "x" << new_ylim << " from: " << file << std::endl;
+    return false;
+  }
+
+  // Load fitness matrix, rows land in whatever order the cell layout puts them
+  xlim = new_xlim;
+  ylim = new_ylim;
+  layout = defaultLayout(xlim, ylim);
+  allocate(defaultStorage(xlim, ylim));
+  if (storage == STORAGE_DENSE)
+  {
+    for (int i = 0; i < ylim; ++i)
+      for (int j = 0; j < xlim; ++j)
+        f >> fitness[toCell(j, i)];
+  }
+  else
+  {
+    // Read one row of tiles at a time, only tiles with differing values are stored
+    std::vector<double> band(std::size_t(TILE_SIZE) * xlim);
+    for (int ty = 0; ty < tiles_y; ++ty)
+    {
+      int rows = std::min(TILE_SIZE, ylim - ty * TILE_SIZE);
+      for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < xlim; ++j)
+          f >> band[std::size_t(i) * xlim + j];
+
+      for (int tx = 0; tx < tiles_x; ++tx)
+      {
+        int x0 = tx * TILE_SIZE;
+        int cols = std::min(TILE_SIZE, xlim - x0);
+        double first = band[x0];
+        bool uniform = true;
+        for (int i = 0; i < rows && uniform; ++i)
+          for (int j = 0; j < cols && uniform; ++j)
+            uniform = (band[std::size_t(i) * xlim + x0 + j] == first);
+
+        tile_value[tileAt(tx, ty)] = first;
+        if (!uniform)
+        {
+          double *tile = storeTile(x0, ty * TILE_SIZE);
+          for (int i = 0; i < rows; ++i)
+            for (int j = 0; j < cols; ++j)
+              tile[cellInTile(i, j)] = band[std::size_t(i) * xlim + x0 + j];
+        }
+      }
+    }
+  }
+
+  f.close();
+
+  // Maps with a handful of values (like those in FitnessMaps/) take a byte per cell as a palette
+  if (storage == STORAGE_DENSE)
+  {
+    std::vector<double> values;
+    for (std::size_t cell = 0; cell < cells() && values.size() <= MAX_BYTE_LEVELS; ++cell)
+    {
+      auto place = std::lower_bound(values.begin(), values.end(), fitness[cell]);
+      if (place == values.end() || *place != fitness[cell])
+        values.insert(place, fitness[cell]);
+    }
+    if (values.size() <= MAX_BYTE_LEVELS)
+    {
+      setStorage(STORAGE_PALETTE);
+      return true;
+    }
+  }
+
+  levels_dirty = true;
+  buildNeighborTable();
+  return true;
+}
+
+/*
+ * Function to save the fitness map to file (2D array, row-major like the files load reads)
+ * Arguments: Filepath/name to save to
+ * Returns: Nothing
+ */
+void FitnessMap::save(std::string file) const
+{
+  std::ofstream f(file);
+
+  // Header is size, max fitness and the contour spacing the visualization scripts use
+  double maxfit = get(0, 0);
+  for (int i = 0; i < ylim; ++i)
+    for (int j = 0; j < xlim; ++j)
+      maxfit = std::max(maxfit, get(j, i));
+  f << xlim << " " << ylim << " " << maxfit << " " << maxfit / 10.0 << std::endl;
+
+  for (int i = 0; i < ylim; ++i)
+  {
+    for (int j = 0; j < xlim; ++j)
+      f << get(j, i) << " ";
+    f << std::endl;
+  }
+
+  f.close();
+}
+
+/*
+ * Function to display the fitness map matrix
+ * Arguments: None
+ * Returns: Nothing
+ */
+void FitnessMap::display()
+{
+  for (int i = 0; i < ylim; ++i)
+  {
+    for (int j = 0; j < xlim; ++j)
+    {
+      std::cout << int(get(j, i)) << " ";
+    }
+    std::cout << std::endl;
+  }
+}
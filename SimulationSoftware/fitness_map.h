@@ -0,0 +1,282 @@
+#ifndef FITNESS_MAP_H
+#define FITNESS_MAP_H
+
+#include "aligned_array.h"
+#include "landscape.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr int DEFAULT_GENE_SIZE = 100; // Map width and height before one is loaded
+constexpr uint64_t MAX_CELLS = uint64_t(1) << 32; // Cells must fit in an Organism's uint32
+constexpr std::size_t MAX_NEIGHBOR_TABLE_CELLS = std::size_t(1) << 22; // Larger maps compute neighbors on the fly
+constexpr std::size_t MAX_FITNESS_LEVELS = 65536; // Maps with more distinct values have no level table
+constexpr std::size_t MAX_BYTE_LEVELS = 256; // Palette maps with up to this many values use 1 byte levels
+constexpr std::size_t LEVEL_GAP = 16; // Levels given to each value when levels are spread out, the spares take new values
+constexpr std::size_t MIN_BYTE_LEVEL_GAP = 4; // Byte levels move to 2 bytes once values get fewer levels than this
+constexpr std::size_t MAX_DENSE_CELLS = std::size_t(1) << 24; // Larger maps are stored as tiles
+constexpr int TILE_BITS = 6; // Tiles are 64x64 cells
+constexpr int TILE_SIZE = 1 << TILE_BITS;
+constexpr std::size_t TILE_CELLS = std::size_t(TILE_SIZE) * TILE_SIZE;
+constexpr uint32_t UNIFORM_TILE = 0xFFFFFFFF; // Directory entry of a tile with no stored cells
+constexpr std::size_t MIN_MORTON_CELLS = std::size_t(1) << 22; // Smaller maps fit in cache row-major
+constexpr int MAX_MORTON_SIDE = 1 << 16; // Morton cells hold 16 bits of each gene
+
+// Mutation directions, used as the column of the neighbor table
+enum MutationDirection
+{
+  X_INCREASE = 0,
+  X_DECREASE = 1,
+  Y_INCREASE = 2,
+  Y_DECREASE = 3,
+  NUM_DIRECTIONS = 4
+};
+
+// How fitness values are held
+enum FitnessStorage
+{
+  STORAGE_DENSE = 0, // One double per cell
+  STORAGE_TILED = 1, // Only tiles that aren't a single value, memory follows the populated area
+  STORAGE_PROCEDURAL = 2, // Nothing stored, values come from a Landscape (optionally memoized by tile)
+  STORAGE_PALETTE = 3 // A level per cell (1 byte, 2 past 256 values) and a table of the level values
+};
+
+// How (x, y) gene pairs are packed into cells
+enum CellLayout
+{
+  LAYOUT_ROW_MAJOR = 0, // y * xlim + x, same order as .map files
+  LAYOUT_MORTON = 1 // Bits of x and y interleaved (Z-order) on a power of 2 square, nearby genes share cache lines and pages
+};
+
+// What a mutation off the edge of the map does
+enum BoundaryMode
+{
+  BOUNDARY_CLAMP = 0, // Stay on the edge cell
+  BOUNDARY_WRAP = 1, // Come back on the opposite edge (torus)
+  BOUNDARY_REFLECT = 2 // Bounce back one cell from the edge
+};
+
+// Spread the low 16 bits of v to the even bits of the result
+inline uint32_t spreadBits(uint32_t v)
+{
+  v &= 0x0000FFFF;
+  v = (v | (v << 8)) & 0x00FF00FF;
+  v = (v | (v << 4)) & 0x0F0F0F0F;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+  return v;
+}
+
+constexpr uint32_t MORTON_X_BITS = 0x55555555;
+constexpr uint32_t MORTON_Y_BITS = 0xAAAAAAAA;
+
+// Gather the even bits of v into the low 16 bits of the result
+inline uint32_t compactBits(uint32_t v)
+{
+  v &= 0x55555555;
+  v = (v | (v >> 1)) & 0x33333333;
+  v = (v | (v >> 2)) & 0x0F0F0F0F;
+  v = (v | (v >> 4)) & 0x00FF00FF;
+  v = (v | (v >> 8)) & 0x0000FFFF;
+  return v;
+}
+
+struct FitnessMap
+{
+  int xlim; // Max X gene value
+  int ylim; // Max Y gene value
+
+  // Fitness of each cell, cells are packed (x, y) gene pairs, see CellLayout
+  CellLayout layout;
+  int morton_side; // Side of the square Morton cells cover (0 when row-major)
+  uint32_t morton_xmax; // Morton bits of xlim - 1 and ylim - 1, for edge checks without unpacking
+  uint32_t morton_ymax;
+  FitnessStorage storage;
+  AlignedArray<double> fitness; // Dense storage (empty when tiled)
+
+  // Tiled storage, a directory of TILE_SIZE x TILE_SIZE tiles. A tile is either uniform (one value
+  // for all its cells) or stored as TILE_CELLS values in tile_data. Tiles and the cells in them
+  // follow the cell layout, so a Morton cell splits into its tile and offset with no unpacking.
+  int tiles_x; // Tiles per row
+  int tiles_y; // Rows of tiles
+  AlignedArray<uint32_t> tile_slot; // Where each tile is in tile_data (in tiles), or UNIFORM_TILE
+  AlignedArray<double> tile_value; // Value of each uniform tile
+  std::vector<double> tile_data; // Stored tiles
+
+  // Procedural storage, tiles are filled from the landscape as organisms reach them when memoizing
+  Landscape landscape;
+  bool memoize;
+
+  // Cell reached by mutating a cell in each direction, edges are already clamped (empty for huge maps)
+  AlignedArray<uint32_t> neighbors;
+
+  // Fitness value of each level in increasing order and the level of each cell, so comparing levels
+  // compares fitness (empty if the map has too many distinct values). Palette maps store only these.
+  // Once edited, levels are spread out: spare levels repeat the value below them (the lowest repeat
+  // -infinity) and cells are only on the first level of a value, so new values take a spare level.
+  std::vector<double> level_values;
+  AlignedArray<uint16_t> levels;
+  AlignedArray<uint8_t> byte_levels; // Levels of palette maps with at most MAX_BYTE_LEVELS values (levels is then empty)
+  bool levels_dirty; // Fitness changed since levels were built
+
+  // Constructor
+  FitnessMap(int xlim = DEFAULT_GENE_SIZE, int ylim = DEFAULT_GENE_SIZE);
+
+  // Cell packing, cells() counts the unused cells padding a Morton square
+  uint32_t toCell(int x, int y) const
+  {
+    if (layout == LAYOUT_MORTON)
+      return spreadBits(x) | (spreadBits(y) << 1);
+    return uint32_t(y) * xlim + x;
+  }
+  int getX(uint32_t cell) const { return unpackX(cell, xlim, layout); }
+  int getY(uint32_t cell) const { return unpackY(cell, xlim, layout); }
+  std::size_t cells() const
+  {
+    if (layout == LAYOUT_MORTON)
+      return std::size_t(morton_side) * morton_side;
+    return std::size_t(xlim) * ylim;
+  }
+  static int unpackX(uint32_t cell, int xlim, CellLayout layout)
+  {
+    return (layout == LAYOUT_MORTON) ? compactBits(cell) : cell % xlim;
+  }
+  static int unpackY(uint32_t cell, int xlim, CellLayout layout)
+  {
+    return (layout == LAYOUT_MORTON) ? compactBits(cell >> 1) : cell / xlim;
+  }
+  // Cell packed with an old width and layout, moved onto this map (clamped to its size)
+  uint32_t remapCell(uint32_t cell, int old_xlim, CellLayout old_layout) const
+  {
+    return toCell(std::min(unpackX(cell, old_xlim, old_layout), xlim - 1),
+                  std::min(unpackY(cell, old_xlim, old_layout), ylim - 1));
+  }
+
+  // Lookups used by the simulation, a table read (plus a directory read when tiled)
+  double operator[](uint32_t cell) const
+  {
+    if (storage == STORAGE_DENSE)
+      return fitness[cell];
+    if (storage == STORAGE_PALETTE)
+      return level_values[level(cell)];
+    if (storage == STORAGE_TILED)
+    {
+      if (layout == LAYOUT_MORTON)
+        return tileValue(cell >> (2 * TILE_BITS), cell & (TILE_CELLS - 1));
+      return tiledValue(getX(cell), getY(cell));
+    }
+    return proceduralValue(getX(cell), getY(cell));
+  }
+  double tiledValue(int x, int y) const { return tileValue(tileIndex(x, y), tileOffset(x, y)); }
+  double tileValue(std::size_t tile, std::size_t offset) const
+  {
+    uint32_t slot = tile_slot[tile];
+    if (slot == UNIFORM_TILE)
+      return tile_value[tile];
+    return tile_data[slot * TILE_CELLS + offset];
+  }
+  double proceduralValue(int x, int y) const
+  {
+    if (!tile_slot.empty())
+    {
+      uint32_t slot = tile_slot[tileIndex(x, y)];
+      if (slot != UNIFORM_TILE)
+        return tile_data[slot * TILE_CELLS + tileOffset(x, y)];
+    }
+    return landscape.value(x, y);
+  }
+
+  // Tile addressing, directory entry of tile (tx, ty) and place of a cell (row i, column j) in a tile
+  std::size_t tileAt(int tx, int ty) const
+  {
+    if (layout == LAYOUT_MORTON)
+      return spreadBits(tx) | (spreadBits(ty) << 1);
+    return std::size_t(ty) * tiles_x + tx;
+  }
+  std::size_t cellInTile(int i, int j) const
+  {
+    if (layout == LAYOUT_MORTON)
+      return spreadBits(j) | (spreadBits(i) << 1);
+    return (std::size_t(i) << TILE_BITS) + j;
+  }
+  std::size_t tileIndex(int x, int y) const { return tileAt(x >> TILE_BITS, y >> TILE_BITS); }
+  std::size_t tileOffset(int x, int y) const { return cellInTile(y & (TILE_SIZE - 1), x & (TILE_SIZE - 1)); }
+  uint32_t neighbor(uint32_t cell, int dir) const
+  {
+    if (!neighbors.empty())
+      return neighbors[NUM_DIRECTIONS * std::size_t(cell) + dir];
+    return computeNeighbor(cell, dir);
+  }
+  uint32_t computeNeighbor(uint32_t cell, int dir) const;
+  uint32_t mortonNeighbor(uint32_t cell, int dir) const;
+  uint32_t wrapNeighbor(uint32_t cell, int dir) const;
+  uint32_t reflectNeighbor(uint32_t cell, int dir) const;
+
+  // Neighbor under any boundary mode, clamping uses the table
+  uint32_t step(uint32_t cell, int dir, BoundaryMode boundary) const
+  {
+    switch(boundary)
+    {
+    case BOUNDARY_WRAP:
+      return wrapNeighbor(cell, dir);
+    case BOUNDARY_REFLECT:
+      return reflectNeighbor(cell, dir);
+    default:
+      return neighbor(cell, dir);
+    }
+  }
+
+  // Level of a cell, valid after updateLevels returns true
+  uint32_t level(uint32_t cell) const { return byte_levels.empty() ? levels[cell] : byte_levels[cell]; }
+  void setLevel(uint32_t cell, uint32_t new_level)
+  {
+    if (byte_levels.empty())
+      levels[cell] = new_level;
+    else
+      byte_levels[cell] = new_level;
+  }
+
+  // Access by gene values
+  double get(int x, int y) const;
+  void set(int x, int y, double value);
+
+  // Change map dimensions, keeping values that are still in bounds
+  static bool validSize(int xlim, int ylim);
+  bool resize(int xlim, int ylim);
+  void buildNeighborTable();
+
+  // Cell layout, chosen by size unless set explicitly (cells change, so organisms must be remapped)
+  static CellLayout defaultLayout(int xlim, int ylim);
+  void setLayout(CellLayout new_layout);
+
+  // Storage layout, chosen by size unless set explicitly
+  static FitnessStorage defaultStorage(int xlim, int ylim);
+  void allocate(FitnessStorage new_storage);
+  void setStorage(FitnessStorage new_storage);
+  void copyCells(const FitnessMap &old);
+  bool buildPalette(const FitnessMap &old);
+  std::size_t levelCapacity() const { return byte_levels.empty() ? MAX_FITNESS_LEVELS : MAX_BYTE_LEVELS; }
+  bool levelFor(double value, std::size_t &new_level);
+  bool spreadLevels(double value);
+  double *storeTile(int x, int y);
+  void compactTiles();
+  std::size_t storageBytes() const;
+
+  // Procedural landscapes, memoized tiles are only filled between generations so lookups stay read only
+  bool setLandscape(const Landscape &new_landscape, int new_xlim, int new_ylim, bool memoize_tiles = false);
+  void memoizeCell(uint32_t cell);
+
+  // Rebuild fitness levels if the map changed, returns false if there are too many to index
+  bool updateLevels();
+
+  // File IO, files are row-major whatever the cell layout
+  bool load(std::string file);
+  void save(std::string file) const;
+
+  // Display functions
+  void display();
+};
+
+#endif
@@ -0,0 +1,429 @@
+#include "infinite_population.h"
+#include "thread_count.h"
+#include "engine.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+/*
+ * Constructs an infinite population
+ * Arguments: mutation rate, starting x gene, starting y gene
+ * Returns: InfinitePopulation
+ */
+InfinitePopulation::InfinitePopulation(double m, int xstart, int ystart) :
+  m(m),
+  fitness_map(std::max(DEFAULT_GENE_SIZE, xstart + 1), std::max(DEFAULT_GENE_SIZE, ystart + 1)),
+  freq(std::size_t(fitness_map.xlim) * fitness_map.ylim),
+  next(std::size_t(fitness_map.xlim) * fitness_map.ylim)
+{
+  gen = 0; // Generation number, starts at 0
+  boundary = BOUNDARY_CLAMP;
+  threads = 0;
+  rank_pressure = DEFAULT_RANK_PRESSURE;
+  truncation_share = DEFAULT_TRUNCATION_SHARE;
+
+  // Whole population at start of current genetic map (fitness map starts as all 0s)
+  freq[std::size_t(ystart) * fitness_map.xlim + xstart] = 1.0;
+  newInitPop();
+}
+
+/*
+ * Function that will simulate generations of the expected dynamics
+ * Arguments: How many generations, flag for selection method, tournament size to be used, and flag for saving
+ * Returns: Nothing
+ */
+void InfinitePopulation::evolve(int generations, char selection, int tournament_size, bool save_all, std::string save_dir)
+{
+  std::string file_start = save_dir.append("gen_"); // File path to save to, gen_#, # is determined later
+
+  std::string file;
+  if (save_all)
+  {
+    file = file_start + std::to_string(gen) + ".txt";
+    savePopulation(file);
+  }
+
+  prepare();
+  for (int i = 0; i < generations; ++i)
+  {
+    // Next generation
+    ++gen;
+
+    // Selection reweights the shares, then mutation spreads them to neighbors
+    switch(selection)
+    {
+    case 'r':
+    case 'u': // Universal sampling has the same expected shares as roulette
+      selectionRoulette();
+      break;
+    case 't':
+      selectionTournament(tournament_size);
+      break;
+    case 'k':
+      selectionLinearRank();
+      break;
+    case 'c':
+      selectionTruncation();
+      break;
+    default:
+      selectionTournament(7);
+    }
+    mutate();
+
+    // Save current generation
+    if (save_all)
+    {
+      file = file_start + std::to_string(gen) + ".txt";
+      savePopulation(file);
+    }
+  }
+}
+
+/*
+ * Function to copy fitness values and levels out of the map in row-major order
+ * Arguments: None
+ * Returns: Nothing
+ */
+void InfinitePopulation::prepare()
+{
+  int xlim = fitness_map.xlim;
+  int ylim = fitness_map.ylim;
+  std::size_t cells = std::size_t(xlim) * ylim;
+  fit.resize(cells);
+  level.resize(cells);
+  row_sums.resize(ylim);
+  zero_row.assign(xlim, 0.0);
+
+  for (int y = 0; y < ylim; ++y)
+    for (int x = 0; x < xlim; ++x)
+      fit[std::size_t(y) * xlim + x] = fitness_map.get(x, y);
+
+  // Levels order the same as fitness, use the map's when it has them
+  if (fitness_map.updateLevels())
+  {
+    for (int y = 0; y < ylim; ++y)
+      for (int x = 0; x < xlim; ++x)
+        level[std::size_t(y) * xlim + x] = fitness_map.level(fitness_map.toCell(x, y));
+    level_mass.resize(fitness_map.level_values.size());
+    return;
+  }
+
+  std::vector<double> values(fit.begin(), fit.end());
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  for (std::size_t i = 0; i < cells; ++i)
+    level[i] = std::lower_bound(values.begin(), values.end(), fit[i]) - values.begin();
+  level_mass.resize(values.size());
+}
+
+/*
+ * Function to set a new initial population start (saves current shares)
+ * Arguments: None
+ * Returns: None
+ */
+void InfinitePopulation::newInitPop()
+{
+  init_freq = freq;
+}
+
+/*
+ * Function to reset a population
+ * Arguments: None
+ * Returns: Nothing
+ */
+void InfinitePopulation::reset()
+{
+  gen = 0;
+  freq = init_freq;
+}
+
+/*
+ * Function to apply roulette selection: each share grows in proportion to its fitness
+ * Arguments: None
+ * Returns: Nothing
+ */
+void InfinitePopulation::selectionRoulette()
+{
+  std::size_t cells = freq.size();
+  double *share = freq.data();
+  double *out = next.data();
+  const double *f = fit.data();
+
+  #pragma omp parallel for simd num_threads(threadCount(threads)) schedule(static)
+  for (std::size_t i = 0; i < cells; ++i)
+    out[i] = share[i] * f[i];
+
+  // Ensure population isn't dead
+  double total = sumRows(out);
+  if (total == 0)
+  {
+    std::cout << "Population is dead, can't evolve!" << std::endl;
+    exit(1);
+  }
+
+  double scale = sumRows(share) / total;
+  #pragma omp parallel for simd num_threads(threadCount(threads)) schedule(static)
+  for (std::size_t i = 0; i < cells; ++i)
+    out[i] *= scale;
+  std::swap(freq, next);
+}
+
+/*
+ * Function to apply selection by fitness rank. A parent's level is f with probability
+ * share(P(fit <= f)) - share(P(fit < f)) for the rank policy's share, spread over the level by share.
+ * Arguments: Rank policy
+ * Returns: Nothing
+ */
+template <typename Rank>
+void InfinitePopulation::selectionByRank(const Rank &rank_policy)
+{
+  std::size_t cells = freq.size();
+
+  // Share on each level (in cell order, so sums don't depend on threads)
+  std::fill(level_mass.begin(), level_mass.end(), 0.0);
+  for (std::size_t i = 0; i < cells; ++i)
+    level_mass[level[i]] += freq[i];
+  double total = 0.0;
+  for (double mass : level_mass)
+    total += mass;
+
+  // Turn each level's share into the factor its cells grow by
+  double below = 0.0; // Share on lower levels
+  for (double &mass : level_mass)
+  {
+    double level_share = mass;
+    if (level_share > 0)
+      mass = (rank_policy.share((below + level_share) / total) - rank_policy.share(below / total)) * total / level_share;
+    below += level_share;
+  }
+
+  double *share = freq.data();
+  double *out = next.data();
+  const uint32_t *l = level.data();
+  const double *growth = level_mass.data();
+  #pragma omp parallel for simd num_threads(threadCount(threads)) schedule(static)
+  for (std::size_t i = 0; i < cells; ++i)
+    out[i] = share[i] * growth[l[i]];
+  std::swap(freq, next);
+}
+
+/*
+ * Function to apply tournament selection, the winner of a tournament of size t is in the lowest x
+ * of the population with probability x^t
+ * Arguments: Tournament size
+ * Returns: Nothing
+ */
+void InfinitePopulation::selectionTournament(int t)
+{
+  t = std::max(t, 1);
+  selectionByRank(TournamentRank{double(t), 1.0 / t});
+}
+
+/*
+ * Function to apply linear rank selection
+ * Arguments: None
+ * Returns: Nothing
+ */
+void InfinitePopulation::selectionLinearRank()
+{
+  selectionByRank(LinearRank{std::min(std::max(rank_pressure, 1.0), 2.0)});
+}
+
+/*
+ * Function to apply truncation selection
+ * Arguments: None
+ * Returns: Nothing
+ */
+void InfinitePopulation::selectionTruncation()
+{
+  double kept = std::min(truncation_share, 1.0);
+  if (!(kept > 0))
+    kept = std::numeric_limits<double>::min();
+  selectionByRank(TruncationRank{kept});
+}
+
+/*
+ * Function to apply mutation: a share m of each gene pair moves, split evenly over the four
+ * directions. Moves within the map are a fixed stencil, moves off the edge go where the boundary
+ * mode sends them.
+ * Arguments: None
+ * Returns: Nothing
+ */
+void InfinitePopulation::mutate()
+{
+  int xlim = fitness_map.xlim;
+  int ylim = fitness_map.ylim;
+  double keep = 1.0 - m;
+  double move = m / double(NUM_DIRECTIONS);
+
+  // Every cell gathers from its neighbors inside the map
+  #pragma omp parallel for num_threads(threadCount(threads)) schedule(static)
+  for (int y = 0; y < ylim; ++y)
+  {
+    const double *row = freq.data() + std::size_t(y) * xlim;
+    const double *up = (y > 0) ? row - xlim : zero_row.data();
+    const double *down = (y < ylim - 1) ? row + xlim : zero_row.data();
+    double *out = next.data() + std::size_t(y) * xlim;
+
+    #pragma omp simd
+    for (int x = 1; x < xlim - 1; ++x)
+      out[x] = keep * row[x] + move * (row[x - 1] + row[x + 1] + up[x] + down[x]);
+
+    out[0] = keep * row[0] + move * (((xlim > 1) ? row[1] : 0.0) + up[0] + down[0]);
+    if (xlim > 1)
+      out[xlim - 1] = keep * row[xlim - 1] + move * (row[xlim - 2] + up[xlim - 1] + down[xlim - 1]);
+  }
+
+  // Edge cells send their moves off the map to wherever the boundary puts them
+  auto edge = [&](int x, int y)
+  {
+    double share = move * freq[std::size_t(y) * xlim + x];
+    bool off[NUM_DIRECTIONS];
+    off[X_INCREASE] = (x == xlim - 1);
+    off[X_DECREASE] = (x == 0);
+    off[Y_INCREASE] = (y == ylim - 1);
+    off[Y_DECREASE] = (y == 0);
+    for (int dir = 0; dir < NUM_DIRECTIONS; ++dir)
+    {
+      if (!off[dir])
+        continue;
+      uint32_t cell = fitness_map.step(fitness_map.toCell(x, y), dir, boundary);
+      next[std::size_t(fitness_map.getY(cell)) * xlim + fitness_map.getX(cell)] += share;
+    }
+  };
+  for (int x = 0; x < xlim; ++x)
+  {
+    edge(x, 0);
+    if (ylim > 1)
+      edge(x, ylim - 1);
+  }
+  for (int y = 1; y < ylim - 1; ++y)
+  {
+    edge(0, y);
+    if (xlim > 1)
+      edge(xlim - 1, y);
+  }
+
+  std::swap(freq, next);
+}
+
+/*
+ * Function to get the population's mean fitness
+ * Arguments: None
+ * Returns: Mean fitness
+ */
+double InfinitePopulation::meanFitness()
+{
+  if (fit.size() != freq.size())
+    prepare();
+
+  std::size_t cells = freq.size();
+  #pragma omp parallel for simd num_threads(threadCount(threads)) schedule(static)
+  for (std::size_t i = 0; i < cells; ++i)
+    next[i] = freq[i] * fit[i];
+  return sumRows(next.data()) / sumRows(freq.data());
+}
+
+/*
+ * Function to add up row-major values a row at a time, rows in parallel and then the row sums in
+ * order, so the total is the same for any thread count
+ * Arguments: values
+ * Returns: Sum
+ */
+double InfinitePopulation::sumRows(const double *values)
+{
+  int xlim = fitness_map.xlim;
+  int ylim = fitness_map.ylim;
+  row_sums.resize(ylim);
+
+  #pragma omp parallel for num_threads(threadCount(threads)) schedule(static)
+  for (int y = 0; y < ylim; ++y)
+  {
+    const double *row = values + std::size_t(y) * xlim;
+    double sum = 0.0;
+    #pragma omp simd reduction(+:sum)
+    for (int x = 0; x < xlim; ++x)
+      sum += row[x];
+    row_sums[y] = sum;
+  }
+
+  double total = 0.0;
+  for (double sum : row_sums)
+    total += sum;
+  return total;
+}
+
+/*
+ * Function to move shares onto a resized map, gene pairs past the new edge go to the edge
+ * Arguments: Map width and height the shares were laid out for
+ * Returns: Nothing
+ */
+void InfinitePopulation::resizeFitnessMap(int old_xlim, int old_ylim)
+{
+  int xlim = fitness_map.xlim;
+  int ylim = fitness_map.ylim;
+  auto remap = [=](const AlignedArray<double> &old)
+  {
+    AlignedArray<double> shares(std::size_t(xlim) * ylim);
+    for (int y = 0; y < old_ylim; ++y)
+      for (int x = 0; x < old_xlim; ++x)
+        shares[std::size_t(std::min(y, ylim - 1)) * xlim + std::min(x, xlim - 1)] += old[std::size_t(y) * old_xlim + x];
+    return shares;
+  };
+
+  freq = remap(freq);
+  init_freq = remap(init_freq);
+  next = AlignedArray<double>(freq.size());
+  fit.clear();
+}
+
+/*
+ * Function to use a procedural landscape instead of a loaded fitness map, shares keep their genes
+ * Arguments: landscape, width, height, flag to memoize tiles (unused, every cell is read once per run)
+ * Returns: Nothing
+ */
+void InfinitePopulation::useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize)
+{
+  int old_xlim = fitness_map.xlim;
+  int old_ylim = fitness_map.ylim;
+  if (fitness_map.setLandscape(landscape, xlim, ylim, memoize))
+    resizeFitnessMap(old_xlim, old_ylim);
+}
+
+/*
+ * Function to save the shares to file, one line per occupied gene pair with its share after the
+ * fitness (Population files have one line per organism)
+ * Arguments: Filepath/name to save to
+ * Returns: Nothing
+ */
+void InfinitePopulation::savePopulation(std::string file)
+{
+  std::ofstream f(file);
+
+  f << "M " << m << std::endl;
+  f << "G " << gen << std::endl;
+
+  int xlim = fitness_map.xlim;
+  for (int y = 0; y < fitness_map.ylim; ++y)
+    for (int x = 0; x < xlim; ++x)
+      if (freq[std::size_t(y) * xlim + x] > 0)
+        f << x << " " << y << " " << fitness_map.get(x, y) << " " << freq[std::size_t(y) * xlim + x] << std::endl;
+
+  f.close();
+}
+
+/*
+ * Function to load a fitness function from file (2D array)
+ * Arguments: Filepath/name to load from
+ * Returns: Nothing
+ */
+void InfinitePopulation::loadFitnessFunction(std::string file)
+{
+  int old_xlim = fitness_map.xlim;
+  int old_ylim = fitness_map.ylim;
+  if (fitness_map.load(file))
+    resizeFitnessMap(old_xlim, old_ylim);
+}
@@ -0,0 +1,71 @@
+#ifndef INFINITE_POPULATION_H
+#define INFINITE_POPULATION_H
+
+#include "aligned_array.h"
+#include "fitness_map.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Infinite population (replicator-mutator dynamics): the share of the population on each gene pair,
+// evolved by the exact expected effect of selection and then of the 4 direction mutation stencil.
+// One deterministic run gives the behavior stochastic runs average out to as n grows.
+struct InfinitePopulation
+{
+  double m; // Mutation rate
+  int gen; // Current generation number
+  BoundaryMode boundary; // Where mutations off the map edge go
+  int threads; // OpenMP threads for the kernels, 0 uses the OpenMP default
+  double rank_pressure; // Rank selection ('k'), expected children of the fittest, the least fit expects 2 - this
+  double truncation_share; // Truncation selection ('c'), share of the population kept
+
+  FitnessMap fitness_map;
+
+  // Shares are row-major (y * xlim + x) whatever the map's cell layout, so the stencil is fixed offsets
+  AlignedArray<double> freq; // Share of the population on each gene pair, sums to 1
+  AlignedArray<double> next; // Next generation, swapped with freq
+  AlignedArray<double> init_freq; // Initial shares, used for resetting
+
+  // Per evolve scratch, taken from the map when a run starts
+  AlignedArray<double> fit; // Fitness of each gene pair
+  AlignedArray<uint32_t> level; // Rank of each gene pair's fitness among the distinct values
+  std::vector<double> level_mass; // Share on each fitness level
+  std::vector<double> row_sums; // Per row partial sums, added in order so results don't depend on threads
+  std::vector<double> zero_row; // Stands in for the rows past the map edge
+
+  // Population constructor, everything starts on one gene pair
+  InfinitePopulation(double m = 0.01,
+                     int xstart = 0,
+                     int ystart = 0);
+
+  // Main simulation
+  void evolve(int generations = 100,
+              char selection = 't',
+              int tournament_size = 7,
+              bool save_all = false,
+              std::string save_dir = "./TestData");
+  void prepare();
+  void newInitPop();
+  void reset();
+
+  // Generation steps
+  void selectionRoulette();
+  void selectionTournament(int t);
+  void selectionLinearRank();
+  void selectionTruncation();
+  template <typename Rank>
+  void selectionByRank(const Rank &rank);
+  void mutate();
+  double meanFitness();
+  double sumRows(const double *values);
+
+  // Fitness map changes, shares stay on the same genes (clamped to the new map)
+  void resizeFitnessMap(int old_xlim, int old_ylim);
+  void useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize = false);
+
+  // File IO
+  void savePopulation(std::string file);
+  void loadFitnessFunction(std::string file);
+};
+
+#endif
@@ -0,0 +1,280 @@
+#include "island_model.h"
+#include "thread_count.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+/*
+ * Constructs an Island, tournament selection until set otherwise
+ * Arguments: size of population, mutation rate, starting x gene, starting y gene
+ * Returns: Island
+ */
+Island::Island(int n, double m, int xstart, int ystart) :
+  pop(n, m, xstart, ystart)
+{
+  selection = 't';
+  tournament_size = 7;
+}
+
+/*
+ * Constructs an IslandModel of identical islands on a ring
+ * Arguments: number of islands, size of each population, mutation rate, starting x gene, starting y gene
+ * Returns: IslandModel
+ */
+IslandModel::IslandModel(int num_islands, int n, double m, int xstart, int ystart)
+{
+  gen = 0; // Generation number, starts at 0
+  migration_interval = 10;
+  migrants = 1;
+  threads = 0;
+
+  for (int i = 0; i < num_islands; ++i)
+    islands.emplace_back(n, m, xstart, ystart);
+  setTopology(TOPOLOGY_RING);
+
+  // Island i uses seed + i
+  emp::Random rng;
+  setSeed(rng.GetSeed());
+}
+
+/*
+ * Function that will simulate generations of every island, migrating every migration_interval
+ * generations (counted from generation 0, so runs split over several calls migrate at the same
+ * generations as one long run)
+ * Arguments: How many generations, flag for saving
+ * Returns: Nothing
+ */
+void IslandModel::evolve(int generations, bool save_all, std::string save_dir)
+{
+  int k = islands.size();
+  if (k == 0)
+  {
+    std::cout << "Cannot evolve without islands" << std::endl;
+    return;
+  }
+  if (targets.size() != islands.size())
+    setTopology(topology, grid_width);
+
+  // Stretches of generations between migrations, worked out up front so threads only share islands
+  std::vector<int> steps;
+  std::vector<char> migrate_after;
+  for (int g = gen; g < gen + generations;)
+  {
+    int step = gen + generations - g;
+    if (migration_interval > 0)
+      step = std::min(step, migration_interval - g % migration_interval);
+    g += step;
+    steps.push_back(step);
+    migrate_after.push_back(migration_interval > 0 && migrants > 0 && g % migration_interval == 0);
+  }
+
+  // One thread per island unless set, more would only wait at the barriers
+  #pragma omp parallel num_threads((threads > 0) ? threads : std::max(1, std::min(k, threadCount(0))))
+  {
+    for (std::size_t s = 0; s < steps.size(); ++s)
+    {
+      // Islands take different times with different sizes, so hand them out as threads free up
+      #pragma omp for schedule(dynamic, 1)
+      for (int i = 0; i < k; ++i)
+      {
+        Island &island = islands[i];
+        island.pop.evolve(steps[s], island.selection, island.tournament_size, save_all,
+                          save_dir + "island_" + std::to_string(i) + "_");
+      }
+
+      // Every outbox is filled before any is read, the barriers at the end of each loop order them
+      if (migrate_after[s])
+      {
+        #pragma omp for schedule(static)
+        for (int i = 0; i < k; ++i)
+          sendMigrants(i);
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < k; ++i)
+          receiveMigrants(i);
+      }
+    }
+  }
+
+  gen += generations;
+}
+
+/*
+ * Function to set the selection method of every island
+ * Arguments: flag for selection method, tournament size
+ * Returns: Nothing
+ */
+void IslandModel::setSelection(char selection, int tournament_size)
+{
+  for (auto &island : islands)
+  {
+    island.selection = selection;
+    island.tournament_size = tournament_size;
+  }
+}
+
+/*
+ * Function to set which islands exchange migrants
+ * Arguments: topology, islands per grid row (0 picks the most square grid)
+ * Returns: Nothing
+ */
+void IslandModel::setTopology(MigrationTopology topology, int grid_width)
+{
+  int k = islands.size();
+  this->grid_width = grid_width;
+
+  // Grids need whole rows, the most square one has the largest width up to sqrt(k) that divides k
+  int width = grid_width;
+  if (topology == TOPOLOGY_GRID && width <= 0)
+    for (width = std::max(1, int(std::sqrt(double(k)))); k % width != 0; --width);
+  if (topology == TOPOLOGY_GRID && (width > k || k % width != 0))
+  {
+    std::cout << "Grid width must divide the number of islands, using a ring" << std::endl;
+    topology = TOPOLOGY_RING;
+  }
+  this->topology = topology;
+
+  targets.assign(k, std::vector<int>());
+  for (int i = 0; i < k; ++i)
+  {
+    std::vector<int> &to = targets[i];
+    switch(topology)
+    {
+    case TOPOLOGY_GRID:
+    {
+      // Neighbors on the wrapped grid, small grids can name the same island twice or the island itself
+      int height = k / width;
+      int x = i % width;
+      int y = i / width;
+      to = {y * width + (x + 1) % width,
+            y * width + (x + width - 1) % width,
+            ((y + 1) % height) * width + x,
+            ((y + height - 1) % height) * width + x};
+      std::sort(to.begin(), to.end());
+      to.erase(std::unique(to.begin(), to.end()), to.end());
+      to.erase(std::remove(to.begin(), to.end(), i), to.end());
+      break;
+    }
+    case TOPOLOGY_FULL:
+      for (int j = 0; j < k; ++j)
+        if (j != i)
+          to.push_back(j);
+      break;
+    default:
+      if (k > 1)
+        to.push_back((i + 1) % k);
+    }
+  }
+
+  // Sources in island order, so immigrants arrive in the same order every run
+  sources.assign(k, std::vector<std::pair<int, int>>());
+  for (int i = 0; i < k; ++i)
+    for (std::size_t link = 0; link < targets[i].size(); ++link)
+      sources[targets[i][link]].push_back(std::make_pair(i, int(link)));
+}
+
+/*
+ * Function to fill an island's outbox with copies of random residents, migrants per target
+ * Arguments: Island
+ * Returns: Nothing
+ */
+void IslandModel::sendMigrants(int i)
+{
+  Population &pop = islands[i].pop;
+  const AlignedArray<Organism> &current = pop.first_pop ? pop.pop1 : pop.pop2;
+
+  std::vector<Organism> &outbox = islands[i].outbox;
+  outbox.resize(targets[i].size() * migrants);
+  for (auto &migrant : outbox)
+    migrant = current[pop.rng.GetInt(0, pop.n)];
+}
+
+/*
+ * Function to move the migrants addressed to an island out of its sources' outboxes, each
+ * replacing a random resident
+ * Arguments: Island
+ * Returns: Nothing
+ */
+void IslandModel::receiveMigrants(int i)
+{
+  Population &pop = islands[i].pop;
+  AlignedArray<Organism> &current = pop.first_pop ? pop.pop1 : pop.pop2;
+
+  for (auto &source : sources[i])
+  {
+    const std::vector<Organism> &outbox = islands[source.first].outbox;
+    for (int j = 0; j < migrants; ++j)
+      current[pop.rng.GetInt(0, pop.n)] = outbox[std::size_t(source.second) * migrants + j];
+  }
+  pop.cells_sorted = false;
+}
+
+/*
+ * Function to set a new initial population start for every island (saves current populations)
+ * Arguments: None
+ * Returns: None
+ */
+void IslandModel::newInitPop()
+{
+  for (auto &island : islands)
+    island.pop.newInitPop();
+}
+
+/*
+ * Function to reset every island
+ * Arguments: None
+ * Returns: Nothing
+ */
+void IslandModel::reset()
+{
+  gen = 0;
+  for (auto &island : islands)
+  {
+    island.pop.reset();
+    island.outbox.clear();
+  }
+}
+
+/*
+ * Function to seed the islands, island i gets seed + i
+ * Arguments: Base seed
+ * Returns: Nothing
+ */
+void IslandModel::setSeed(int seed)
+{
+  for (std::size_t i = 0; i < islands.size(); ++i)
+    islands[i].pop.setSeed(int(int64_t(seed) + i));
+}
+
+/*
+ * Function to save one island to file, in the Population format
+ * Arguments: Island, filepath/name to save to
+ * Returns: Nothing
+ */
+void IslandModel::savePopulation(int i, std::string file)
+{
+  islands[i].pop.savePopulation(file);
+}
+
+/*
+ * Function to load a fitness function from file (2D array) into every island. The file is parsed
+ * once, each island gets its own copy so islands never share a map across threads.
+ * Arguments: Filepath/name to load from
+ * Returns: Nothing
+ */
+void IslandModel::loadFitnessFunction(std::string file)
+{
+  FitnessMap map;
+  if (!map.load(file))
+    return;
+
+  for (auto &island : islands)
+  {
+    // Organism cells depend on the map width, so repack them after copying
+    Population &pop = island.pop;
+    int old_xlim = pop.fitness_map.xlim;
+    CellLayout old_layout = pop.fitness_map.layout;
+    pop.fitness_map = map;
+    pop.remapOrganisms(old_xlim, old_layout);
+  }
+}
@@ -0,0 +1,73 @@
+#ifndef ISLAND_MODEL_H
+#define ISLAND_MODEL_H
+
+#include "evolution.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Which islands exchange migrants
+enum MigrationTopology
+{
+  TOPOLOGY_RING = 0, // Island i sends to island i + 1, the last to the first
+  TOPOLOGY_GRID = 1, // Islands on a wrapped grid, each sends to its 4 neighbors
+  TOPOLOGY_FULL = 2 // Every island sends to every other
+};
+
+// One deme of an island model, with its own size, mutation rate and selection method
+struct Island
+{
+  Population pop;
+  char selection; // Selection method flag, as for Population::evolve
+  int tournament_size;
+  std::vector<Organism> outbox; // Emigrants of the last migration, migrants per target in target order
+
+  Island(int n, double m, int xstart, int ystart);
+};
+
+// k islands that evolve apart and exchange migrants every migration_interval generations. Each
+// island runs on its own thread between migrations. At a migration every island fills its own
+// outbox, then after a barrier reads its sources' outboxes, so the exchange needs no locks. Every
+// random draw of an island comes from its own generator (island i gets seed + i), so results only
+// depend on the seed, not on the thread count or scheduling.
+struct IslandModel
+{
+  int gen; // Current generation number, shared by all islands
+  std::vector<Island> islands;
+
+  // Migration
+  MigrationTopology topology;
+  int grid_width; // Islands per grid row, 0 picks the most square grid
+  int migration_interval; // Generations between migrations, 0 never migrates
+  int migrants; // Organisms sent along each link, copies of random residents that replace random residents
+  std::vector<std::vector<int>> targets; // Islands each island sends to
+  std::vector<std::vector<std::pair<int, int>>> sources; // (island, outbox offset) each island receives from
+
+  int threads; // OpenMP threads, 0 uses one per island (at most the OpenMP default)
+
+  // Island model constructor, every island starts the same
+  IslandModel(int num_islands = 4,
+              int n = 10000,
+              double m = 0.01,
+              int xstart = 0,
+              int ystart = 0);
+
+  // Main simulation
+  void evolve(int generations = 100,
+              bool save_all = false,
+              std::string save_dir = "./TestData");
+  void setSelection(char selection, int tournament_size = 7);
+  void setTopology(MigrationTopology topology, int grid_width = 0);
+  void sendMigrants(int i);
+  void receiveMigrants(int i);
+  void newInitPop();
+  void reset();
+  void setSeed(int seed);
+
+  // File IO
+  void savePopulation(int i, std::string file);
+  void loadFitnessFunction(std::string file);
+};
+
+#endif
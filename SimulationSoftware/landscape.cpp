@@ -0,0 +1,171 @@
+#include "landscape.h"
+#include <cmath>
+
+/*
+ * Constructs a flat landscape of 0
+ * Arguments: None
+ * Returns: Landscape
+ */
+Landscape::Landscape() :
+  shape(LANDSCAPE_FLAT),
+  base(0.0),
+  height(0.0),
+  step_x(0.0),
+  step_y(0.0),
+  cx(0.0),
+  cy(0.0),
+  inner(0.0),
+  outer(0.0),
+  cx2(0.0),
+  cy2(0.0),
+  radius2(-1.0),
+  height2(0.0),
+  spacing(1),
+  thickness(0)
+{
+}
+
+/*
+ * Function to make a landscape with the same fitness everywhere
+ * Arguments: fitness
+ * Returns: Landscape
+ */
+Landscape Landscape::flat(double value)
+{
+  Landscape l;
+  l.base = value;
+  return l;
+}
+
+/*
+ * Function to make a plane sloping up from the origin
+ * Arguments: fitness at (0, 0), gain per x step, gain per y step
+ * Returns: Landscape
+ */
+Landscape Landscape::slope(double origin, double step_x, double step_y)
+{
+  Landscape l;
+  l.shape = LANDSCAPE_SLOPE;
+  l.height = origin;
+  l.step_x = step_x;
+  l.step_y = step_y;
+  return l;
+}
+
+/*
+ * Function to make a ring (annulus) of higher fitness
+ * Arguments: center x, center y, inner radius, outer radius, fitness off the ring, fitness on it
+ * Returns: Landscape
+ */
+Landscape Landscape::ring(double cx, double cy, double inner, double outer, double base, double height)
+{
+  Landscape l;
+  l.shape = LANDSCAPE_RING;
+  l.cx = cx;
+  l.cy = cy;
+  l.inner = inner;
+  l.outer = outer;
+  l.base = base;
+  l.height = height;
+  return l;
+}
+
+/*
+ * Function to make two round peaks, the higher one wins where they overlap
+ * Arguments: fitness off the peaks, first peak center x, y, radius, fitness, then the same for the
+ *            second peak (a negative radius leaves it out)
+ * Returns: Landscape
+ */
+Landscape Landscape::peaks(double base, double cx, double cy, double radius, double height,
+                           double cx2, double cy2, double radius2, double height2)
+{
+  Landscape l;
+  l.shape = LANDSCAPE_PEAKS;
+  l.base = base;
+  l.cx = cx;
+  l.cy = cy;
+  l.outer = radius;
+  l.height = height;
+  l.cx2 = cx2;
+  l.cy2 = cy2;
+  l.radius2 = radius2;
+  l.height2 = height2;
+  return l;
+}
+
+/*
+ * Function to make a comb: a slope along the first rows and along evenly spaced columns
+ * Arguments: columns between teeth, tooth width, fitness off the comb, fitness at (0, 0), gain per step
+ * Returns: Landscape
+ */
+Landscape Landscape::comb(int spacing, int thickness, double base, double origin, double step)
+{
+  Landscape l;
+  l.shape = LANDSCAPE_COMB;
+  l.spacing = (spacing > 0) ? spacing : 1;
+  l.thickness = thickness;
+  l.base = base;
+  l.height = origin;
+  l.step_x = step;
+  l.step_y = step;
+  return l;
+}
+
+/*
+ * Function to make a landscape with a single fit cell at (0, 0)
+ * Arguments: fitness elsewhere, fitness of the corner
+ * Returns: Landscape
+ */
+Landscape Landscape::corner(double base, double height)
+{
+  return peaks(base, 0.0, 0.0, 0.0, height, 0.0, 0.0, -1.0, 0.0);
+}
+
+/*
+ * Function to size a preset feature from its size in the 10x10 and 100x100 FitnessMaps/ files, the
+ * files aren't scaled copies of each other so sizes in between (and past) follow the line through both
+ * Arguments: size on a 10 cell map, size on a 100 cell map, map size
+ * Returns: Size on this map
+ */
+static double fileScale(double at10, double at100, double size)
+{
+  return at10 + (at100 - at10) * (size - 10.0) / 90.0;
+}
+
+/*
+ * Function to get a built in landscape by the name of its FitnessMaps/ file (without the size
+ * prefix). At the file's size the landscape matches the file cell for cell, at other sizes
+ * features are scaled and centers kept on whole cells.
+ * Arguments: name, map width, map height, landscape to fill in
+ * Returns: True if the name is known
+ */
+bool Landscape::named(std::string name, int xlim, int ylim, Landscape &landscape)
+{
+  double s = std::min(xlim, ylim);
+  double mx = xlim / 2;
+  double my = ylim / 2;
+
+  if (name == "flat")
+    landscape = flat(1.0);
+  else if (name == "major_slope")
+    landscape = slope(1.0, 1.0, 1.0);
+  else if (name == "slight_slope")
+    landscape = slope(10000.0, 1.0, 1.0);
+  else if (name == "ring")
+    landscape = ring(mx, my, fileScale(3.1, 9.7, s), fileScale(4.7, 15.7, s), 0.0, 1.0);
+  else if (name == "raised_ring")
+    landscape = ring(mx, my, 0.2 * s, 0.3 * s, 1.0, 10.0);
+  else if (name == "comb")
+    landscape = comb(10, 2, 0.0, 1.0, 1.0);
+  else if (name == "big_vs_small_unequal_peaks")
+    landscape = peaks(1.0, std::round(fileScale(2.0, 38.0, xlim)), my, fileScale(2.5, 10.02, s), 80.0,
+                      std::round(fileScale(8.0, 52.0, xlim)), my, 0.0, 85.0);
+  else if (name == "big_vs_small_equal_peaks")
+    landscape = peaks(9.0, std::round(fileScale(2.0, 25.0, xlim)), my, fileScale(2.5, 5.5, s), 10.0,
+                      std::round(fileScale(8.0, 75.0, xlim)), my, fileScale(0.5, 3.4, s), 10.0);
+  else if (name == "corner")
+    landscape = corner(0.0, 1.0);
+  else
+    return false;
+  return true;
+}
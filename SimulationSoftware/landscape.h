@@ -0,0 +1,74 @@
+#ifndef LANDSCAPE_H
+#define LANDSCAPE_H
+
+#include <algorithm>
+#include <string>
+
+// Shapes of the built in landscapes, matching the kinds of maps in FitnessMaps/
+enum LandscapeShape
+{
+  LANDSCAPE_FLAT = 0, // base everywhere
+  LANDSCAPE_SLOPE = 1, // height + step_x * x + step_y * y
+  LANDSCAPE_RING = 2, // height between radii inner and outer of (cx, cy), base elsewhere
+  LANDSCAPE_PEAKS = 3, // height within outer of (cx, cy), height2 within radius2 of (cx2, cy2)
+  LANDSCAPE_COMB = 4 // Slope along a backbone (first rows) and teeth (columns), base elsewhere
+};
+
+// Fitness landscape given by a formula, evaluated per cell so it costs no memory at any size
+struct Landscape
+{
+  LandscapeShape shape;
+  double base; // Fitness off the feature
+  double height; // Fitness on the feature, or at the origin for slopes and combs
+  double step_x; // Fitness gained per x gene step (slope, comb)
+  double step_y; // Fitness gained per y gene step (slope, comb)
+  double cx, cy; // Ring or first peak center
+  double inner, outer; // Ring radii, outer is also the first peak's radius
+  double cx2, cy2; // Second peak center
+  double radius2; // Second peak radius, negative for no second peak
+  double height2; // Second peak fitness
+  int spacing; // Comb columns between teeth
+  int thickness; // Comb tooth and backbone width
+
+  // Constructor, flat landscape of 0
+  Landscape();
+
+  // Built in landscapes
+  static Landscape flat(double value);
+  static Landscape slope(double origin, double step_x, double step_y);
+  static Landscape ring(double cx, double cy, double inner, double outer, double base, double height);
+  static Landscape peaks(double base, double cx, double cy, double radius, double height,
+                         double cx2, double cy2, double radius2, double height2);
+  static Landscape comb(int spacing, int thickness, double base, double origin, double step);
+  static Landscape corner(double base, double height);
+  static bool named(std::string name, int xlim, int ylim, Landscape &landscape);
+
+  // Fitness of a gene pair
+  double value(int x, int y) const
+  {
+    switch(shape)
+    {
+    case LANDSCAPE_SLOPE:
+      return height + step_x * x + step_y * y;
+    case LANDSCAPE_RING:
+    {
+      double d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+      return (d2 >= inner * inner && d2 <= outer * outer) ? height : base;
+    }
+    case LANDSCAPE_PEAKS:
+    {
+      bool first = (x - cx) * (x - cx) + (y - cy) * (y - cy) <= outer * outer;
+      bool second = radius2 >= 0 && (x - cx2) * (x - cx2) + (y - cy2) * (y - cy2) <= radius2 * radius2;
+      if (first && second)
+        return std::max(height, height2);
+      return first ? height : (second ? height2 : base);
+    }
+    case LANDSCAPE_COMB:
+      return (y < thickness || x % spacing < thickness) ? height + step_x * x + step_y * y : base;
+    default:
+      return base;
+    }
+  }
+};
+
+#endif
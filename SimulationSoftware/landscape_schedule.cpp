@@ -0,0 +1,195 @@
+#include "landscape_schedule.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <limits>
+
+/*
+ * Function to parse a map file, run on a background thread when prefetching
+ * Arguments: Filepath/name to load from
+ * Returns: Whether the map loaded, and the map
+ */
+static std::pair<bool, FitnessMap> parseMap(std::string file)
+{
+  std::pair<bool, FitnessMap> parsed;
+  parsed.first = parsed.second.load(file);
+  return parsed;
+}
+
+/*
+ * Constructs an empty LandscapeSchedule
+ * Arguments: None
+ * Returns: LandscapeSchedule
+ */
+LandscapeSchedule::LandscapeSchedule()
+{
+  next = 0;
+  prefetch = true;
+  pending_step = 0;
+}
+
+/*
+ * Function to switch to a map file at a generation
+ * Arguments: generation, filepath/name of the map
+ * Returns: Nothing
+ */
+void LandscapeSchedule::addMap(int gen, std::string file)
+{
+  ScheduledLandscape step;
+  step.gen = gen;
+  step.file = file;
+  insert(step);
+}
+
+/*
+ * Function to change some cells at a generation
+ * Arguments: generation, changed cells
+ * Returns: Nothing
+ */
+void LandscapeSchedule::addChanges(int gen, const std::vector<CellChange> &changes)
+{
+  ScheduledLandscape step;
+  step.gen = gen;
+  step.changes = changes;
+  insert(step);
+}
+
+/*
+ * Function to read cell changes from a file, one "x y value" line per cell
+ * Arguments: generation, filepath/name to load from
+ * Returns: True if the changes were read
+ */
+bool LandscapeSchedule::loadChanges(int gen, std::string file)
+{
+  std::ifstream f(file);
+  if (!f)
+  {
+    std::cout << "Cell changes are missing: " << file << std::endl;
+    return false;
+  }
+
+  std::vector<CellChange> changes;
+  CellChange change;
+  while (f >> change.x >> change.y >> change.value)
+    changes.push_back(change);
+  if (!f.eof())
+  {
+    std::cout << "Cell changes couldn't be read past line " << changes.size() << " of: " << file << std::endl;
+    return false;
+  }
+
+  addChanges(gen, changes);
+  return true;
+}
+
+/*
+ * Function to add a step after every step at or before its generation
+ * Arguments: step
+ * Returns: Nothing
+ */
+void LandscapeSchedule::insert(const ScheduledLandscape &step)
+{
+  auto later = std::upper_bound(steps.begin() + next, steps.end(), step.gen,
+                                [](int gen, const ScheduledLandscape &s) { return gen < s.gen; });
+  std::size_t index = later - steps.begin();
+  steps.insert(later, step);
+
+  // A prefetch for a step that moved keeps pointing at it
+  if (pending.valid() && pending_step >= index)
+    ++pending_step;
+  startPrefetch();
+}
+
+/*
+ * Function to get the generation of the next step
+ * Arguments: None
+ * Returns: Generation, or the largest int if there are no steps left
+ */
+int LandscapeSchedule::nextGen() const
+{
+  return (next < steps.size()) ? steps[next].gen : std::numeric_limits<int>::max();
+}
+
+/*
+ * Function to apply every step due by a generation. Cells are only written where the value
+ * changes, a map of another size replaces the current one.
+ * Arguments: generation, map to change, cells that changed are added here if given
+ * Returns: True if the map was replaced (its cells must be remapped), else false
+ */
+bool LandscapeSchedule::apply(int gen, FitnessMap &map, std::vector<uint32_t> *changed)
+{
+  bool replaced = false;
+  for (; due(gen); ++next)
+  {
+    const ScheduledLandscape &step = steps[next];
+    for (const CellChange &change : step.changes)
+    {
+      if (change.x < 0 || change.x >= map.xlim || change.y < 0 || change.y >= map.ylim)
+        continue;
+      if (map.get(change.x, change.y) != change.value)
+      {
+        map.set(change.x, change.y, change.value);
+        if (changed)
+          changed->push_back(map.toCell(change.x, change.y));
+      }
+    }
+    if (step.file.empty())
+      continue;
+
+    // Use the background parse if it is for this step
+    if (!(pending.valid() && pending_step == next))
+      pending = std::async(std::launch::deferred, parseMap, step.file).share();
+    const std::pair<bool, FitnessMap> &parsed = pending.get();
+    const FitnessMap &new_map = parsed.second;
+    if (!parsed.first)
+    {
+      std::cout << "Skipping scheduled map " << step.file << std::endl;
+    }
+    else if (new_map.xlim != map.xlim || new_map.ylim != map.ylim)
+    {
+      map = new_map;
+      replaced = true;
+    }
+    else
+    {
+      for (int y = 0; y < map.ylim; ++y)
+      {
+        for (int x = 0; x < map.xlim; ++x)
+        {
+          double value = new_map.get(x, y);
+          if (map.get(x, y) != value)
+          {
+            map.set(x, y, value);
+            if (changed)
+              changed->push_back(map.toCell(x, y));
+          }
+        }
+      }
+    }
+    pending = std::shared_future<std::pair<bool, FitnessMap>>();
+  }
+
+  startPrefetch();
+  return replaced;
+}
+
+/*
+ * Function to start parsing the next map file on a background thread, if one isn't already
+ * Arguments: None
+ * Returns: Nothing
+ */
+void LandscapeSchedule::startPrefetch()
+{
+  if (!prefetch || pending.valid())
+    return;
+
+  for (std::size_t i = next; i < steps.size(); ++i)
+  {
+    if (!steps[i].file.empty())
+    {
+      pending = std::async(std::launch::async, parseMap, steps[i].file).share();
+      pending_step = i;
+      return;
+    }
+  }
+}
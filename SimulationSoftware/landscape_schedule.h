@@ -0,0 +1,58 @@
+#ifndef LANDSCAPE_SCHEDULE_H
+#define LANDSCAPE_SCHEDULE_H
+
+#include "fitness_map.h"
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+// New fitness of one gene pair
+struct CellChange
+{
+  int x;
+  int y;
+  double value;
+};
+
+// One step of a schedule, a whole map file or a few changed cells
+struct ScheduledLandscape
+{
+  int gen; // In effect from this generation on, applied before its children are made
+  std::string file; // Map to switch to, empty for cell changes
+  std::vector<CellChange> changes;
+};
+
+// Fitness maps that change during a run. Each step only writes the cells whose value differs
+// (a whole map is compared against the current one cell by cell), so fitness levels and any per
+// cell caches are updated in place instead of rebuilt. The next map file is parsed on a
+// background thread while generations run. Steps are applied once, in generation order.
+struct LandscapeSchedule
+{
+  std::vector<ScheduledLandscape> steps; // In generation order
+  std::size_t next; // First step not applied yet
+  bool prefetch; // Parse the next map file in the background
+
+  // Background parse of the next map file, false if it couldn't be loaded
+  std::shared_future<std::pair<bool, FitnessMap>> pending;
+  std::size_t pending_step;
+
+  // Constructor, empty schedule
+  LandscapeSchedule();
+
+  // Building the schedule
+  void addMap(int gen, std::string file);
+  void addChanges(int gen, const std::vector<CellChange> &changes);
+  bool loadChanges(int gen, std::string file);
+  void insert(const ScheduledLandscape &step);
+
+  // Running the schedule
+  bool due(int gen) const { return next < steps.size() && steps[next].gen <= gen; }
+  int nextGen() const;
+  bool apply(int gen, FitnessMap &map, std::vector<uint32_t> *changed = nullptr);
+  void startPrefetch();
+};
+
+#endif
@@ -0,0 +1,399 @@
+#include "moran.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/*
+ * Constructs a Moran (birth-death) Population
+ * Arguments: size of population, mutation rate, starting x gene, starting y gene
+ * Returns: MoranPopulation
+ */
+MoranPopulation::MoranPopulation(uint64_t n, double m, int xstart, int ystart) :
+  n(n),
+  m(m),
+  fitness_map(std::max(DEFAULT_GENE_SIZE, xstart + 1), std::max(DEFAULT_GENE_SIZE, ystart + 1))
+{
+  gen = 0; // Generation number, starts at 0
+  events = 0;
+  time = 0.0;
+  continuous_time = false;
+
+  // Initialize population at start of current genetic map (fitness map starts as all 0s)
+  std::vector<std::pair<uint32_t, uint64_t>> start;
+  if (n > 0)
+    start.push_back(std::make_pair(fitness_map.toCell(xstart, ystart), n));
+  setCells(start);
+  newInitPop();
+}
+
+/*
+ * Function that will simulate generation equivalents of birth-death events
+ * Arguments: How many generation equivalents, flag for selection method, tournament size to be
+ *            used, and flag for saving
+ * Returns: Nothing
+ */
+void MoranPopulation::evolve(int generations, char selection, int tournament_size, bool save_all, std::string save_dir)
+{
+  std::string file_start = save_dir.append("gen_"); // File path to save to, gen_#, # is determined later
+
+  // Ensure that there is a population
+  if (n == 0)
+  {
+    std::cout << "Cannot evolve with an empty population" << std::endl;
+    return;
+  }
+
+  std::string file;
+  if (save_all)
+  {
+    file = file_start + std::to_string(gen) + ".txt";
+    savePopulation(file);
+  }
+
+  for (int i = 0; i < generations; ++i)
+  {
+    // Events until the clock reaches the next generation equivalent
+    ++gen;
+    if (schedule.due(gen))
+      applySchedule();
+    while (time < gen)
+      event(selection, tournament_size);
+
+    // Weight sums drift as doubles are added and removed, so each generation starts them exact
+    rebuildTrees();
+
+    // Save current generation
+    if (save_all)
+    {
+      file = file_start + std::to_string(gen) + ".txt";
+      savePopulation(file);
+    }
+  }
+}
+
+/*
+ * Function to run one birth-death event: a parent is selected, its (maybe mutated) child
+ * replaces a uniformly random organism, and the clock advances
+ * Arguments: flag for selection method, tournament size
+ * Returns: Nothing
+ */
+void MoranPopulation::event(char selection, int tournament_size)
+{
+  uint32_t parent;
+  switch(selection)
+  {
+  case 'r':
+  case 'u': // Universal sampling with one pointer per event is a roulette spin
+    parent = selectionRoulette();
+    break;
+  case 't':
+    parent = selectionTournament(tournament_size);
+    break;
+  default:
+    parent = selectionTournament(7);
+  }
+
+  // Mutations stay on the map edge like generational runs
+  uint32_t cell = slot_cell[parent];
+  if (rng.P(m))
+    cell = fitness_map.neighbor(cell, rng.GetInt(0, NUM_DIRECTIONS));
+
+  // Death is uniform over the organisms there before the birth
+  removeOrganism(pickOrganism());
+  addOrganisms(cell, 1);
+
+  ++events;
+  if (continuous_time)
+    time -= std::log1p(-rng.GetDouble()) / n;
+  else
+    time = double(events) / n;
+}
+
+/*
+ * Function to set a new initial population start (saves current population)
+ * Arguments: None
+ * Returns: None
+ */
+void MoranPopulation::newInitPop()
+{
+  init_cells = occupiedCells();
+}
+
+/*
+ * Function to reset a population
+ * Arguments: None
+ * Returns: Nothing
+ */
+void MoranPopulation::reset()
+{
+  gen = 0;
+  events = 0;
+  time = 0.0;
+  setCells(init_cells);
+}
+
+/*
+ * Function to pick a parent via tournament selection, ties go to the first organism drawn
+ * Arguments: Tournament size
+ * Returns: Slot of the winner
+ */
+uint32_t MoranPopulation::selectionTournament(int t)
+{
+  uint32_t max_slot = pickOrganism();
+  for (int j = 0; j < t - 1; ++j)
+  {
+    uint32_t slot = pickOrganism();
+    if (slot_fitness[slot] > slot_fitness[max_slot])
+      max_slot = slot;
+  }
+  return max_slot;
+}
+
+/*
+ * Function to pick a parent via roulette selection
+ * Arguments: None
+ * Returns: Slot of the parent
+ */
+uint32_t MoranPopulation::selectionRoulette()
+{
+  while (true)
+  {
+    // Ensure population isn't dead
+    double total = births.total();
+    if (!(total > 0))
+    {
+      std::cout << "Population is dead, can't evolve!" << std::endl;
+      exit(1);
+    }
+
+    // A draw can only land on an empty or 0 fitness slot through drift, exact sums fix that
+    uint32_t slot = births.find(rng.GetDouble() * total);
+    if (slot_count[slot] > 0 && slot_fitness[slot] > 0)
+      return slot;
+    rebuildTrees();
+  }
+}
+
+/*
+ * Function to pick an organism uniformly
+ * Arguments: None
+ * Returns: Slot of the organism
+ */
+uint32_t MoranPopulation::pickOrganism()
+{
+  uint64_t target = std::min(uint64_t(rng.GetDouble() * n), n - 1);
+  return organisms.find(target);
+}
+
+/*
+ * Function to add organisms to a cell, giving it a slot if it had none
+ * Arguments: cell, number of organisms
+ * Returns: Nothing
+ */
+void MoranPopulation::addOrganisms(uint32_t cell, uint64_t count)
+{
+  if (count == 0)
+    return;
+
+  uint32_t slot = cell_slot.find(cell);
+  if (slot == EMPTY_SLOT)
+  {
+    // Double the slots when all are used, the trees are rebuilt at the new size
+    if (free_slots.empty())
+    {
+      std::size_t old_slots = slot_cell.size();
+      slot_cell.resize(2 * old_slots);
+      slot_count.resize(2 * old_slots);
+      slot_fitness.resize(2 * old_slots);
+      for (std::size_t s = 2 * old_slots; s > old_slots; --s)
+        free_slots.push_back(s - 1);
+      rebuildTrees();
+    }
+
+    slot = free_slots.back();
+    free_slots.pop_back();
+    cell_slot.set(cell, slot);
+    slot_cell[slot] = cell;
+    slot_fitness[slot] = fitness_map[cell];
+  }
+
+  slot_count[slot] += count;
+  organisms.add(slot, count);
+  births.add(slot, count * slot_fitness[slot]);
+}
+
+/*
+ * Function to remove one organism, freeing its slot if it was the last
+ * Arguments: slot
+ * Returns: Nothing
+ */
+void MoranPopulation::removeOrganism(uint32_t slot)
+{
+  // Counts are unsigned, adding the largest value wraps around to subtracting 1
+  --slot_count[slot];
+  organisms.add(slot, ~uint64_t(0));
+  births.add(slot, -slot_fitness[slot]);
+
+  if (slot_count[slot] == 0)
+  {
+    cell_slot.erase(slot_cell[slot]);
+    free_slots.push_back(slot);
+  }
+}
+
+/*
+ * Function to replace the population with organisms on the given cells, cells may repeat
+ * Arguments: (cell, count) pairs
+ * Returns: Nothing
+ */
+void MoranPopulation::setCells(const std::vector<std::pair<uint32_t, uint64_t>> &cells)
+{
+  uint64_t total = 0;
+  for (auto &c : cells)
+    total += c.second;
+  cell_slot.reset(fitness_map, total);
+
+  // Enough slots for every cell, lowest slots used first
+  std::size_t slots = MIN_MORAN_SLOTS;
+  while (slots < cells.size())
+    slots *= 2;
+  slot_cell.assign(slots, 0);
+  slot_count.assign(slots, 0);
+  slot_fitness.assign(slots, 0.0);
+  free_slots.clear();
+  for (std::size_t s = slots; s > 0; --s)
+    free_slots.push_back(s - 1);
+  rebuildTrees();
+
+  n = 0;
+  for (auto &c : cells)
+  {
+    addOrganisms(c.first, c.second);
+    n += c.second;
+  }
+}
+
+/*
+ * Function to rebuild both Fenwick trees from the slot counts
+ * Arguments: None
+ * Returns: Nothing
+ */
+void MoranPopulation::rebuildTrees()
+{
+  std::vector<double> weights(slot_count.size());
+  for (std::size_t s = 0; s < slot_count.size(); ++s)
+    weights[s] = slot_count[s] * slot_fitness[s];
+
+  organisms.build(slot_count.data(), slot_count.size());
+  births.build(weights.data(), weights.size());
+}
+
+/*
+ * Function to list the occupied cells
+ * Arguments: None
+ * Returns: (cell, count) pairs in cell order
+ */
+std::vector<std::pair<uint32_t, uint64_t>> MoranPopulation::occupiedCells() const
+{
+  std::vector<std::pair<uint32_t, uint64_t>> cells;
+  for (std::size_t s = 0; s < slot_count.size(); ++s)
+    if (slot_count[s] > 0)
+      cells.push_back(std::make_pair(slot_cell[s], slot_count[s]));
+  std::sort(cells.begin(), cells.end());
+  return cells;
+}
+
+/*
+ * Function to repack cells after the fitness map width or layout changed, slot fitness is looked
+ * up again
+ * Arguments: Width and layout the cells were packed with
+ * Returns: Nothing
+ */
+void MoranPopulation::remapCells(int old_xlim, CellLayout old_layout)
+{
+  // Several old cells can land on one new cell when the map shrinks, setCells merges them
+  std::vector<std::pair<uint32_t, uint64_t>> cells = occupiedCells();
+  for (auto &c : cells)
+    c.first = fitness_map.remapCell(c.first, old_xlim, old_layout);
+  for (auto &init : init_cells)
+    init.first = fitness_map.remapCell(init.first, old_xlim, old_layout);
+  setCells(cells);
+}
+
+/*
+ * Function to save a Population to file, one line per organism like Population::savePopulation
+ * Arguments: Filepath/name to save to
+ * Returns: Nothing
+ */
+void MoranPopulation::savePopulation(std::string file)
+{
+  std::ofstream f(file);
+
+  f << "N " << n << std::endl;
+  f << "M " << m << std::endl;
+  f << "G " << gen << std::endl;
+
+  for (auto &c : occupiedCells())
+    for (uint64_t i = 0; i < c.second; ++i)
+      f << fitness_map.getX(c.first) << " " << fitness_map.getY(c.first) << " " << fitness_map[c.first] << std::endl;
+
+  f.close();
+}
+
+/*
+ * Function to load a fitness function from file (2D array)
+ * Arguments: Filepath/name to load from
+ * Returns: Nothing
+ */
+void MoranPopulation::loadFitnessFunction(std::string file)
+{
+  // Cells depend on the map width, so repack them after loading
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.load(file))
+    remapCells(old_xlim, old_layout);
+}
+
+/*
+ * Function to apply the landscape schedule steps due this generation. Slots cache their cell's
+ * fitness, so the slots on changed cells (found through cell_slot) are refreshed and their weight
+ * in the birth tree moves by the difference.
+ * Arguments: None
+ * Returns: Nothing
+ */
+void MoranPopulation::applySchedule()
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  changed_cells.clear();
+  if (schedule.apply(gen, fitness_map, &changed_cells))
+  {
+    remapCells(old_xlim, old_layout);
+    return;
+  }
+
+  for (uint32_t cell : changed_cells)
+  {
+    uint32_t slot = cell_slot.find(cell);
+    if (slot == EMPTY_SLOT)
+      continue;
+    double fit = fitness_map[cell];
+    births.add(slot, slot_count[slot] * (fit - slot_fitness[slot]));
+    slot_fitness[slot] = fit;
+  }
+}
+
+/*
+ * Function to use a procedural landscape instead of a loaded fitness map, organisms keep their genes
+ * Arguments: landscape, width, height, flag to memoize tiles organisms have reached
+ * Returns: Nothing
+ */
+void MoranPopulation::useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize)
+{
+  int old_xlim = fitness_map.xlim;
+  CellLayout old_layout = fitness_map.layout;
+  if (fitness_map.setLandscape(landscape, xlim, ylim, memoize))
+    remapCells(old_xlim, old_layout);
+}
@@ -0,0 +1,89 @@
+#ifndef MORAN_H
+#define MORAN_H
+
+#include "emp/math/Random.hpp"
+#include "cell_index.h"
+#include "fenwick_tree.h"
+#include "fitness_map.h"
+#include "landscape_schedule.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+constexpr uint32_t EMPTY_SLOT = NO_INDEX; // Slot of a cell with no organisms
+constexpr std::size_t MIN_MORAN_SLOTS = 64; // Slots start at this many and double when full
+
+// Overlapping generations: each event is one birth and one death (Moran process). Organisms are
+// counted per occupied cell, and each occupied cell has a slot in Fenwick trees over organisms and
+// over count * fitness, so an event costs O(log occupied cells) instead of O(n).
+struct MoranPopulation
+{
+  uint64_t n; // Number of organisms in population
+  double m; // Mutation rate
+  int gen; // Whole generation equivalents completed
+
+  // Generation equivalents: n events make one, or with continuous_time every organism dies at
+  // rate 1 and the clock advances by exponential gaps (one generation is a mean lifetime)
+  uint64_t events; // Birth-death events so far
+  double time; // Generation equivalents so far
+  bool continuous_time;
+
+  // Random number generator
+  emp::Random rng;
+
+  // Occupied cells and their slots, slots are reused as cells empty
+  FitnessMap fitness_map;
+  CellIndex cell_slot; // Slot of each occupied cell, EMPTY_SLOT if unoccupied
+  std::vector<uint32_t> slot_cell; // Cell of each slot
+  std::vector<uint64_t> slot_count; // Organisms in each slot
+  std::vector<double> slot_fitness; // Fitness of each slot's cell
+  std::vector<uint32_t> free_slots; // Unused slots, lowest last
+  FenwickTree<uint64_t> organisms; // Organisms per slot, deaths and tournament entrants are uniform
+  FenwickTree<double> births; // count * fitness per slot, roulette parents
+  std::vector<std::pair<uint32_t, uint64_t>> init_cells; // Initial (cell, count) pairs, used for resetting
+
+  // Fitness map changes applied at the start of the generation equivalents they are scheduled for,
+  // only occupied slots on changed cells have their fitness refreshed
+  LandscapeSchedule schedule;
+  std::vector<uint32_t> changed_cells; // Cells the last schedule step changed
+
+  // Population constructor
+  MoranPopulation(uint64_t n = 10000,
+                  double m = 0.01,
+                  int xstart = 0,
+                  int ystart = 0);
+
+  // Main simulation, runs events for the given number of generation equivalents
+  void evolve(int generations = 100,
+              char selection = 't',
+              int tournament_size = 7,
+              bool save_all = false,
+              std::string save_dir = "./TestData");
+  void event(char selection, int tournament_size);
+  void newInitPop();
+  void reset();
+
+  // Parent selection methods, return the parent's slot
+  uint32_t selectionTournament(int t);
+  uint32_t selectionRoulette();
+  uint32_t pickOrganism();
+
+  // Slot bookkeeping
+  void addOrganisms(uint32_t cell, uint64_t count);
+  void removeOrganism(uint32_t slot);
+  void setCells(const std::vector<std::pair<uint32_t, uint64_t>> &cells);
+  void rebuildTrees();
+  std::vector<std::pair<uint32_t, uint64_t>> occupiedCells() const;
+
+  // Fitness map changes, keeps organisms on the same genes
+  void applySchedule();
+  void useLandscape(const Landscape &landscape, int xlim, int ylim, bool memoize = false);
+  void remapCells(int old_xlim, CellLayout old_layout);
+
+  // File IO
+  void savePopulation(std::string file);
+  void loadFitnessFunction(std::string file);
+};
+
+#endif
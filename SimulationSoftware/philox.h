@@ -0,0 +1,113 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Philox4x32-10: 10 rounds mixing a 128 bit counter (c0..c3, replaced by the output) under a 64 bit
+// key. Takes scalars rather than arrays so loops running it for many keys can be vectorized.
+inline void philoxRounds(uint32_t k0, uint32_t k1, uint32_t &c0, uint32_t &c1, uint32_t &c2, uint32_t &c3)
+{
+  constexpr uint32_t MUL0 = 0xD2511F53;
+  constexpr uint32_t MUL1 = 0xCD9E8D57;
+  constexpr uint32_t WEYL0 = 0x9E3779B9;
+  constexpr uint32_t WEYL1 = 0xBB67AE85;
+
+  for (int round = 0; round < 10; ++round)
+  {
+    uint64_t p0 = uint64_t(MUL0) * c0;
+    uint64_t p1 = uint64_t(MUL1) * c2;
+    uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+    uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+    c1 = uint32_t(p1);
+    c3 = uint32_t(p0);
+    c0 = n0;
+    c2 = n2;
+    k0 += WEYL0;
+    k1 += WEYL1;
+  }
+}
+
+// Philox4x32-10 block function on array arguments
+inline void philoxBlock(const uint32_t key[2], const uint32_t ctr[4], uint32_t out[4])
+{
+  uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+  philoxRounds(key[0], key[1], c0, c1, c2, c3);
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+// Fill out with count words of the (seed, stream, index) sequence. Blocks are independent, so the
+// loop has no carried state and can be vectorized.
+inline void philoxFill(uint64_t seed, uint64_t stream, uint32_t index, uint32_t *out, std::size_t count)
+{
+  const uint32_t key[2] = {uint32_t(seed), uint32_t(seed >> 32)};
+  std::size_t blocks = count / 4;
+  for (std::size_t b = 0; b < blocks; ++b)
+  {
+    const uint32_t ctr[4] = {uint32_t(b), index, uint32_t(stream), uint32_t(stream >> 32)};
+    philoxBlock(key, ctr, out + 4 * b);
+  }
+
+  // Partial last block
+  if (count % 4 != 0)
+  {
+    const uint32_t ctr[4] = {uint32_t(blocks), index, uint32_t(stream), uint32_t(stream >> 32)};
+    uint32_t last[4];
+    philoxBlock(key, ctr, last);
+    for (std::size_t i = 0; i < count % 4; ++i)
+      out[4 * blocks + i] = last[i];
+  }
+}
+
+// Counter-based random stream (Philox4x32-10). Every (seed, stream, index) triple names an
+// independent sequence, so results don't depend on which thread draws from it.
+class PhiloxStream
+{
+private:
+  uint32_t key[2]; // Seed
+  uint32_t ctr[4]; // Block within the sequence, index, stream (2 words)
+  uint32_t out[4]; // Current output block
+  int used; // Words of out already handed out
+
+  // Generate the block for the current counter and advance it
+  void nextBlock()
+  {
+    philoxBlock(key, ctr, out);
+    used = 0;
+    ++ctr[0];
+  }
+
+public:
+  PhiloxStream(uint64_t seed, uint64_t stream, uint32_t index) :
+    key{uint32_t(seed), uint32_t(seed >> 32)},
+    ctr{0, index, uint32_t(stream), uint32_t(stream >> 32)},
+    used(4)
+  {
+  }
+
+  uint32_t GetUInt()
+  {
+    if (used == 4)
+      nextBlock();
+    return out[used++];
+  }
+
+  // Uniform double in [0, 1) with 53 random bits
+  double GetDouble()
+  {
+    uint64_t hi = GetUInt() >> 5;
+    uint64_t lo = GetUInt() >> 6;
+    return (hi * 67108864.0 + lo) * (1.0 / 9007199254740992.0);
+  }
+
+  // Uniform integer in [min, max), matches emp::Random::GetInt usage
+  int GetInt(int min, int max) { return min + int(GetDouble() * (max - min)); }
+
+  // True with probability p
+  bool P(double p) { return GetDouble() < p; }
+};
+
+#endif
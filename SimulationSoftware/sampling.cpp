@@ -0,0 +1,56 @@
+#include "sampling.h"
+#include <random>
+
+/*
+ * Function to draw a binomial random variable
+ * Arguments: random number generator, number of trials, success probability
+ * Returns: Number of successes
+ */
+uint64_t sampleBinomial(emp::Random &rng, uint64_t n, double p)
+{
+  if (n == 0 || p <= 0.0)
+    return 0;
+  if (p >= 1.0)
+    return n;
+
+  RandomEngine engine(rng);
+  std::binomial_distribution<uint64_t> binomial(n, p);
+  return binomial(engine);
+}
+
+/*
+ * Function to draw a multinomial random vector as a chain of conditional binomials
+ * Arguments: random number generator, number of draws, category weights, number of categories,
+ *            output counts per category
+ * Returns: Nothing
+ */
+void sampleMultinomial(emp::Random &rng, uint64_t n, const double *weights, std::size_t k, uint64_t *counts)
+{
+  double remaining_weight = 0.0;
+  for (std::size_t i = 0; i < k; ++i)
+    remaining_weight += weights[i];
+
+  for (std::size_t i = 0; i < k; ++i)
+  {
+    if (n == 0 || remaining_weight <= 0.0)
+    {
+      counts[i] = 0;
+      continue;
+    }
+
+    // Category i takes its share of what is left, later categories split the rest
+    counts[i] = sampleBinomial(rng, n, weights[i] / remaining_weight);
+    n -= counts[i];
+    remaining_weight -= weights[i];
+  }
+
+  // Rounding can leave draws unassigned, give them to the last category with weight
+  for (std::size_t i = k; n > 0 && i > 0; --i)
+  {
+    if (weights[i - 1] > 0.0)
+    {
+      counts[i - 1] += n;
+      n = 0;
+    }
+  }
+}
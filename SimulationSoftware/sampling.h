@@ -0,0 +1,41 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include "emp/math/Random.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Adapts emp::Random to the standard library's uniform random bit generator interface
+struct RandomEngine
+{
+  using result_type = uint32_t;
+
+  emp::Random &rng;
+
+  RandomEngine(emp::Random &rng) : rng(rng) {}
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+  result_type operator()() { return rng.GetUInt(); }
+};
+
+// Number of successes in n trials with success probability p
+uint64_t sampleBinomial(emp::Random &rng, uint64_t n, double p);
+
+// Split n draws among k categories by weight (weights need not be normalized), written to counts
+void sampleMultinomial(emp::Random &rng, uint64_t n, const double *weights, std::size_t k, uint64_t *counts);
+
+// Number of failures before the first success, given log(1 - p). Used to skip straight to the next
+// event instead of flipping a coin per trial. Works with any generator that has GetDouble().
+template <typename RNG>
+uint64_t sampleGeometric(RNG &rng, double log_fail)
+{
+  if (log_fail == 0.0) // p = 0, never succeeds
+    return std::numeric_limits<uint64_t>::max();
+  double gap = std::floor(std::log(1.0 - rng.GetDouble()) / log_fail);
+  return (gap < 1.8e19) ? uint64_t(gap) : std::numeric_limits<uint64_t>::max();
+}
+
+#endif
@@ -0,0 +1,302 @@
+#include "simd_kernels.h"
+#include <algorithm>
+
+// Vector kernels are compiled per function with target attributes, so the rest of the build
+// doesn't need -mavx2 and the program still runs on CPUs without it
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * Function to find the widest instruction set the CPU supports
+ * Arguments: None
+ * Returns: SIMD level
+ */
+SimdLevel detectSimdLevel()
+{
+#ifdef SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return SIMD_AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return SIMD_AVX2;
+  if (__builtin_cpu_supports("sse4.1"))
+    return SIMD_SSE4;
+#endif
+  return SIMD_SCALAR;
+}
+
+/*
+ * Function to get the printable name of a SIMD level
+ * Arguments: SIMD level
+ * Returns: Name
+ */
+const char *simdLevelName(SimdLevel level)
+{
+  switch(level)
+  {
+  case SIMD_SSE4:
+    return "sse4";
+  case SIMD_AVX2:
+    return "avx2";
+  case SIMD_AVX512:
+    return "avx512";
+  default:
+    return "scalar";
+  }
+}
+
+/*
+ * Function to limit a requested level to what the CPU can run
+ * Arguments: Requested SIMD level
+ * Returns: Usable SIMD level
+ */
+static SimdLevel usableLevel(SimdLevel level)
+{
+  static const SimdLevel supported = detectSimdLevel();
+  return std::min(level, supported);
+}
+
+/*
+ * Scalar fitness gather, also finishes the tail of the vector kernels
+ * Arguments: fitness per cell, cells, first and end index, output
+ * Returns: Nothing
+ */
+static void gatherScalar(const double *fitness, const uint32_t *cells, std::size_t begin, std::size_t end, double *out)
+{
+  for (std::size_t i = begin; i < end; ++i)
+    out[i] = fitness[cells[i]];
+}
+
+/*
+ * Scalar tournaments, also finishes the tail of the vector kernels
+ * Arguments: parent fitness, picks (t rows of count), first and end child, count, tournament size, output
+ * Returns: Nothing
+ */
+static void tournamentScalar(const double *fit, const uint32_t *picks, std::size_t begin, std::size_t end,
+                             std::size_t count, int t, uint32_t *winners)
+{
+  for (std::size_t j = begin; j < end; ++j)
+  {
+    uint32_t best = picks[j];
+    double best_fit = fit[best];
+    for (int k = 1; k < t; ++k)
+    {
+      uint32_t parent = picks[k * count + j];
+      if (fit[parent] > best_fit)
+      {
+        best = parent;
+        best_fit = fit[parent];
+      }
+    }
+    winners[j] = best;
+  }
+}
+
+#ifdef SIMD_X86
+
+// Winners are tracked as doubles alongside the fitness so one compare mask blends both
+// (indices are below 2^31, so they convert exactly)
+
+// Gathers and AVX-512 conversions use their masked forms with a zeroed source and every lane set,
+// the plain forms pass GCC an undefined source that -Wall reports as maybe uninitialized
+
+/*
+ * SSE4 tournaments, 2 children per step
+ * Arguments: parent fitness, picks (t rows of count), number of children, tournament size, output
+ * Returns: Children done, the rest are left for the scalar loop
+ */
+__attribute__((target("sse4.1")))
+static std::size_t tournamentSSE4(const double *fit, const uint32_t *picks, std::size_t count, int t, uint32_t *winners)
+{
+  std::size_t j = 0;
+  for (; j + 2 <= count; j += 2)
+  {
+    __m128d best = _mm_set_pd(fit[picks[j + 1]], fit[picks[j]]);
+    __m128d best_idx = _mm_set_pd(picks[j + 1], picks[j]);
+    for (int k = 1; k < t; ++k)
+    {
+      const uint32_t *row = picks + k * count + j;
+      __m128d f = _mm_set_pd(fit[row[1]], fit[row[0]]);
+      __m128d greater = _mm_cmpgt_pd(f, best);
+      best = _mm_blendv_pd(best, f, greater);
+      best_idx = _mm_blendv_pd(best_idx, _mm_set_pd(row[1], row[0]), greater);
+    }
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(winners + j), _mm_cvttpd_epi32(best_idx));
+  }
+  return j;
+}
+
+/*
+ * AVX2 tournaments, 8 children per step
+ * Arguments: parent fitness, picks (t rows of count), number of children, tournament size, output
+ * Returns: Children done, the rest are left for the scalar loop
+ */
+__attribute__((target("avx2")))
+static std::size_t tournamentAVX2(const double *fit, const uint32_t *picks, std::size_t count, int t, uint32_t *winners)
+{
+  const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  std::size_t j = 0;
+  for (; j + 8 <= count; j += 8)
+  {
+    // Two groups of 4 children per step to hide gather latency
+    __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(picks + j));
+    __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(picks + j + 4));
+    __m256d best0 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), fit, p0, all, 8);
+    __m256d best1 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), fit, p1, all, 8);
+    __m256d idx0 = _mm256_cvtepi32_pd(p0);
+    __m256d idx1 = _mm256_cvtepi32_pd(p1);
+    for (int k = 1; k < t; ++k)
+    {
+      const uint32_t *row = picks + k * count + j;
+      p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row));
+      p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + 4));
+      __m256d f0 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), fit, p0, all, 8);
+      __m256d f1 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), fit, p1, all, 8);
+      __m256d greater0 = _mm256_cmp_pd(f0, best0, _CMP_GT_OQ);
+      __m256d greater1 = _mm256_cmp_pd(f1, best1, _CMP_GT_OQ);
+      best0 = _mm256_blendv_pd(best0, f0, greater0);
+      best1 = _mm256_blendv_pd(best1, f1, greater1);
+      idx0 = _mm256_blendv_pd(idx0, _mm256_cvtepi32_pd(p0), greater0);
+      idx1 = _mm256_blendv_pd(idx1, _mm256_cvtepi32_pd(p1), greater1);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(winners + j), _mm256_cvttpd_epi32(idx0));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(winners + j + 4), _mm256_cvttpd_epi32(idx1));
+  }
+  return j;
+}
+
+/*
+ * AVX-512 tournaments, 16 children per step
+ * Arguments: parent fitness, picks (t rows of count), number of children, tournament size, output
+ * Returns: Children done, the rest are left for the scalar loop
+ */
+__attribute__((target("avx512f")))
+static std::size_t tournamentAVX512(const double *fit, const uint32_t *picks, std::size_t count, int t, uint32_t *winners)
+{
+  std::size_t j = 0;
+  for (; j + 16 <= count; j += 16)
+  {
+    // Two groups of 8 children per step to hide gather latency
+    __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(picks + j));
+    __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(picks + j + 8));
+    __m512d best0 = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, p0, fit, 8);
+    __m512d best1 = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, p1, fit, 8);
+    __m512d idx0 = _mm512_maskz_cvtepi32_pd(0xFF, p0);
+    __m512d idx1 = _mm512_maskz_cvtepi32_pd(0xFF, p1);
+    for (int k = 1; k < t; ++k)
+    {
+      const uint32_t *row = picks + k * count + j;
+      p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row));
+      p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + 8));
+      __m512d f0 = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, p0, fit, 8);
+      __m512d f1 = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, p1, fit, 8);
+      __mmask8 greater0 = _mm512_cmp_pd_mask(f0, best0, _CMP_GT_OQ);
+      __mmask8 greater1 = _mm512_cmp_pd_mask(f1, best1, _CMP_GT_OQ);
+      best0 = _mm512_mask_blend_pd(greater0, best0, f0);
+      best1 = _mm512_mask_blend_pd(greater1, best1, f1);
+      idx0 = _mm512_mask_blend_pd(greater0, idx0, _mm512_maskz_cvtepi32_pd(0xFF, p0));
+      idx1 = _mm512_mask_blend_pd(greater1, idx1, _mm512_maskz_cvtepi32_pd(0xFF, p1));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(winners + j), _mm512_maskz_cvttpd_epi32(0xFF, idx0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(winners + j + 8), _mm512_maskz_cvttpd_epi32(0xFF, idx1));
+  }
+  return j;
+}
+
+// Cells are zero extended to 64 bit indices, maps can have more than 2^31 cells
+
+/*
+ * AVX2 fitness gather, 4 cells per step
+ * Arguments: fitness per cell, cells, number of cells, output
+ * Returns: Cells done, the rest are left for the scalar loop
+ */
+__attribute__((target("avx2")))
+static std::size_t gatherAVX2(const double *fitness, const uint32_t *cells, std::size_t count, double *out)
+{
+  const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m256i idx = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + i)));
+    _mm256_storeu_pd(out + i, _mm256_mask_i64gather_pd(_mm256_setzero_pd(), fitness, idx, all, 8));
+  }
+  return i;
+}
+
+/*
+ * AVX-512 fitness gather, 8 cells per step
+ * Arguments: fitness per cell, cells, number of cells, output
+ * Returns: Cells done, the rest are left for the scalar loop
+ */
+__attribute__((target("avx512f")))
+static std::size_t gatherAVX512(const double *fitness, const uint32_t *cells, std::size_t count, double *out)
+{
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m512i idx = _mm512_maskz_cvtepu32_epi64(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + i)));
+    _mm512_storeu_pd(out + i, _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, idx, fitness, 8));
+  }
+  return i;
+}
+
+#endif
+
+/*
+ * Function to look up the fitness of many cells
+ * Arguments: SIMD level, fitness per cell, cells, number of cells, output
+ * Returns: Nothing
+ */
+void gatherFitness(SimdLevel level, const double *fitness, const uint32_t *cells, std::size_t count, double *out)
+{
+  std::size_t done = 0;
+#ifdef SIMD_X86
+  // SSE4 has no gather instruction, so it uses the scalar loop
+  switch(usableLevel(level))
+  {
+  case SIMD_AVX512:
+    done = gatherAVX512(fitness, cells, count, out);
+    break;
+  case SIMD_AVX2:
+    done = gatherAVX2(fitness, cells, count, out);
+    break;
+  default:
+    break;
+  }
+#else
+  (void)level;
+#endif
+  gatherScalar(fitness, cells, done, count, out);
+}
+
+/*
+ * Function to run a block of tournaments
+ * Arguments: SIMD level, parent fitness, picks (t rows of count), number of children, tournament size, output
+ * Returns: Nothing
+ */
+void tournamentWinners(SimdLevel level, const double *fit, const uint32_t *picks, std::size_t count, int t,
+                       uint32_t *winners)
+{
+  std::size_t done = 0;
+#ifdef SIMD_X86
+  switch(usableLevel(level))
+  {
+  case SIMD_AVX512:
+    done = tournamentAVX512(fit, picks, count, t, winners);
+    break;
+  case SIMD_AVX2:
+    done = tournamentAVX2(fit, picks, count, t, winners);
+    break;
+  case SIMD_SSE4:
+    done = tournamentSSE4(fit, picks, count, t, winners);
+    break;
+  default:
+    break;
+  }
+#else
+  (void)level;
+#endif
+  tournamentScalar(fit, picks, done, count, count, t, winners);
+}
@@ -0,0 +1,29 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Instruction sets the kernels are built for, in increasing order of width
+enum SimdLevel
+{
+  SIMD_SCALAR = 0,
+  SIMD_SSE4 = 1,
+  SIMD_AVX2 = 2,
+  SIMD_AVX512 = 3
+};
+
+// Widest level this CPU supports (always SIMD_SCALAR off x86)
+SimdLevel detectSimdLevel();
+const char *simdLevelName(SimdLevel level);
+
+// Bulk fitness lookup: out[i] = fitness[cells[i]]
+void gatherFitness(SimdLevel level, const double *fitness, const uint32_t *cells, std::size_t count, double *out);
+
+// Runs count tournaments of size t at once. picks holds t rows of count parent indices (row k is
+// every child's k-th pick), fit is each parent's fitness. Strictly greater fitness replaces the
+// current winner, so ties go to the first pick like selectionTournament.
+void tournamentWinners(SimdLevel level, const double *fit, const uint32_t *picks, std::size_t count, int t,
+                       uint32_t *winners);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef THREAD_COUNT_H
+#define THREAD_COUNT_H
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*
+ * Function to get the number of threads to run a parallel region with
+ * Arguments: Requested threads, 0 for the OpenMP default
+ * Returns: Thread count, always 1 without OpenMP
+ */
+inline int threadCount([[maybe_unused]] int threads)
+{
+#ifdef _OPENMP
+  return (threads > 0) ? threads : omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+#endif
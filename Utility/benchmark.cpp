@@ -1,4 +1,11 @@
 #include "evolution.h"
+#include "count_population.h"
+#include "ensemble.h"
+#include "moran.h"
+#include "infinite_population.h"
+#include "island_model.h"
+#include "cellular_population.h"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <numeric>
@@ -17,6 +24,18 @@ const int DEFAULT_TOURNAMENT_SIZE = 7;
 const int DEFAULT_X = 5;
 const int DEFAULT_Y = 5;
 const std::string DEFAULT_FITNESS_MAP = "./FitnessMaps/10x10_big_vs_small_unequal_peaks.map";
+const std::string CONVERGING_FITNESS_MAP = "./FitnessMaps/10x10_corner.map";
+const int STOP_CHECK_INTERVAL = 10;
+const double STABLE_TOLERANCE = 0.02;
+const double NEARLY_MONOMORPHIC_SHARE = 0.9;
+const int LARGE_POPULATION_SIZE = 1000000;
+const int LARGE_GENERATIONS = 100;
+
+// Sweeps run by "bench <mode>", each one feature's, so a plain "bench" keeps to the original sweeps
+const std::vector<std::string> BENCH_MODES = {
+  "simd", "selection", "stop", "ranked", "batched", "fastforward", "bucket", "steady", "landscape",
+  "layout", "palette", "count", "moran", "infinite", "threads", "islands", "cellular", "schedule", "ensemble"
+};
 
 template <typename T>
 void SaveResults(std::vector<T> * vec, std::vector<double> * times, std::string filename)
@@ -42,238 +61,902 @@ void PrintProgressBar(int pos, int size, int bar_size = 100)
   std::cout.flush();
 }
 
-void TestPopulations(std::vector<int> * p, std::vector<double> * t, char selection)
+// Times a sweep over values, averaging repeats runs of each (on separate threads when parallel is
+// set). setup(value) prepares a run untimed and returns the timed part, which reports how much work
+// it did (1 for a whole run, or children, events, replicates...) so times are per unit of work.
+template <typename T, typename Setup>
+void TimeSweep(std::string label, std::vector<T> * values, std::vector<double> * t, int repeats, bool parallel, Setup setup)
 {
   t->clear();
-  t->resize(p->size());
+  t->resize(values->size());
 
-  std::vector<double> iteration_times(TESTS);
+  std::vector<double> iteration_times(repeats);
 
-  for (int i = 0; i < p->size(); ++i)
+  for (int i = 0; i < values->size(); ++i)
   {
-      for (int j = 0; j < TESTS; ++j)
-      {
-        auto start = std::chrono::high_resolution_clock::now();
-        Population pop(p->at(i), DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
-        pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
-        pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
-  
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-        iteration_times[j] = (duration.count() / 1000000000.0);
-      }
-    t->at(i) = (std::accumulate(iteration_times.begin(), iteration_times.end(), 0.0) / TESTS);
+    #pragma omp parallel for if(parallel)
+    for (int j = 0; j < repeats; ++j)
+    {
+      auto run = setup(values->at(i));
+
+      auto start = std::chrono::high_resolution_clock::now();
+      double work = run();
+
+      auto end = std::chrono::high_resolution_clock::now();
+      auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+      iteration_times[j] = (duration.count() / 1000000000.0) / work;
+    }
+    t->at(i) = (std::accumulate(iteration_times.begin(), iteration_times.end(), 0.0) / repeats);
 
-    std::cout << "Population " << p->at(i) << ": ";
-    PrintProgressBar(i, p->size());
+    std::cout << label << " " << values->at(i) << ": ";
+    PrintProgressBar(i, values->size());
   }
   std::cout << std::endl;
 }
 
+void TestPopulations(std::vector<int> * p, std::vector<double> * t, char selection)
+{
+  TimeSweep("Population", p, t, TESTS, false, [=](int size)
+  {
+    return [=]()
+    {
+      Population pop(size, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
+
 void TestGenerations(std::vector<int> * g, std::vector<double> * t, char selection)
 {
-  t->clear();
-  t->resize(g->size());
+  TimeSweep("Generations", g, t, TESTS, true, [=](int generations)
+  {
+    return [=]()
+    {
+      Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(generations, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
 
-  std::vector<double> iteration_times(TESTS);
+void TestStableWindows(std::vector<int> * w, std::vector<double> * t, char selection)
+{
+  // Runs on a map where the population settles on the peak, stopping once occupancy stays put. They
+  // start on the peak, the rest of the map has no fitness for roulette to pick from.
+  TimeSweep("Stable window", w, t, TESTS, true, [=](int window)
+  {
+    return [=]()
+    {
+      Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, 0, 0);
+      pop.loadFitnessFunction(CONVERGING_FITNESS_MAP);
+      pop.check_interval = STOP_CHECK_INTERVAL;
+      pop.stable_window = window;
+      pop.stable_tolerance = STABLE_TOLERANCE;
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
 
-  for (int i = 0; i < g->size(); ++i)
+void TestTournamentSizes(std::vector<int> * s, std::vector<double> * t, char selection, bool ranked = false)
+{
+  TimeSweep("Tournament size", s, t, TESTS, true, [=](int size)
   {
-    #pragma omp parallel
+    return [=]()
     {
-      #pragma omp for
-      for (int j = 0; j < TESTS; ++j)
-      {
-        auto start = std::chrono::high_resolution_clock::now();
-        Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
-        pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
-        pop.evolve(g->at(i), selection, DEFAULT_TOURNAMENT_SIZE);
-  
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-        iteration_times[j] = (duration.count() / 1000000000.0);
-      }
-    }
-    t->at(i) = (std::accumulate(iteration_times.begin(), iteration_times.end(), 0.0) / TESTS);
+      Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.ranked_tournament = ranked;
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(DEFAULT_GENERATIONS, selection, size);
+      return 1.0;
+    };
+  });
+}
 
-    std::cout << "Generations " << g->at(i) << ": ";
-    PrintProgressBar(i, g->size());
-  }
-  std::cout << std::endl;
+void TestMutationRates(std::vector<double> * m, std::vector<double> * t, char selection, bool batched = false)
+{
+  TimeSweep("Mutations", m, t, TESTS, true, [=](double rate)
+  {
+    return [=]()
+    {
+      Population pop(DEFAULT_POPULATION_SIZE, rate, DEFAULT_X, DEFAULT_Y);
+      pop.batched_rng = batched;
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
 }
 
-void TestTournamentSizes(std::vector<int> * s, std::vector<double> * t, char selection)
+void TestFastForwardRates(std::vector<double> * m, std::vector<double> * t, char selection, bool fast_forward, double monomorphic_share = 0.0)
 {
-  t->clear();
-  t->resize(s->size());
+  TimeSweep("Mutations", m, t, TESTS, true, [=](double rate)
+  {
+    return [=]()
+    {
+      Population pop(DEFAULT_POPULATION_SIZE, rate, DEFAULT_X, DEFAULT_Y);
+      pop.fast_forward = fast_forward;
+      pop.monomorphic_share = monomorphic_share;
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
 
-  std::vector<double> iteration_times(TESTS);
+void TestFitnessMapSizes(std::vector<int> * f, std::vector<double> * t, char selection)
+{
+  TimeSweep("Fitness map size", f, t, TESTS, true, [=](int size)
+  {
+    return [=]()
+    {
+      Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
 
-  for (int i = 0; i < s->size(); ++i)
+void TestMoranPopulations(std::vector<uint64_t> * p, std::vector<double> * t, char selection)
+{
+  // Birth-death events for the same generation equivalents as generational runs, reported as time per event
+  TimeSweep("Moran population", p, t, 1, false, [=](uint64_t size)
   {
-    #pragma omp parallel
+    MoranPopulation pop(size, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+    pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+    return [=, pop = std::move(pop)]() mutable
     {
-      #pragma omp for
-      for (int j = 0; j < TESTS; ++j)
-      {
-        auto start = std::chrono::high_resolution_clock::now();
-        Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
-        pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
-        pop.evolve(DEFAULT_GENERATIONS, selection, s->at(i));
-  
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-        iteration_times[j] = (duration.count() / 1000000000.0);
-      }
-    }
-    t->at(i) = (std::accumulate(iteration_times.begin(), iteration_times.end(), 0.0) / TESTS);
+      pop.evolve(LARGE_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return double(pop.events);
+    };
+  });
+}
 
-    std::cout << "Tournament size " << s->at(i) << ": ";
-    PrintProgressBar(i, s->size());
-  }
-  std::cout << std::endl;
+void TestInfinitePopulations(std::vector<int> * f, std::vector<double> * t, char selection)
+{
+  // Expected dynamics on raised rings, one deterministic run in place of TESTS stochastic ones
+  TimeSweep("Infinite population map size", f, t, 1, false, [=](int size)
+  {
+    Landscape landscape;
+    Landscape::named("raised_ring", size, size, landscape);
+    InfinitePopulation pop(DEFAULT_MUTATION_RATE, size / 2, size / 2);
+    pop.useLandscape(landscape, size, size);
+    return [=, pop = std::move(pop)]() mutable
+    {
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
 }
 
-void TestMutationRates(std::vector<double> * m, std::vector<double> * t, char selection)
+void TestThreadCounts(std::vector<int> * c, std::vector<double> * t, char selection)
 {
-  t->clear();
-  t->resize(m->size());
+  // One large population split across threads, so tests run one at a time
+  TimeSweep("Threads", c, t, 1, false, [=](int threads)
+  {
+    return [=]()
+    {
+      Population pop(LARGE_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.parallel = true;
+      pop.threads = threads;
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(LARGE_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
 
-  std::vector<double> iteration_times(TESTS);
+void TestIslandCounts(std::vector<int> * k, std::vector<double> * t, char selection)
+{
+  // Islands run on their own threads, so tests run one at a time. With a thread per island the time
+  // stays flat as islands are added.
+  TimeSweep("Islands", k, t, 1, false, [=](int islands)
+  {
+    return [=]()
+    {
+      IslandModel model(islands, DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      model.setSelection(selection, DEFAULT_TOURNAMENT_SIZE);
+      model.setTopology(TOPOLOGY_FULL);
+      model.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      model.evolve(DEFAULT_GENERATIONS);
+      return 1.0;
+    };
+  });
+}
 
-  for (int i = 0; i < m->size(); ++i)
+void TestCellularLattices(std::vector<int> * w, std::vector<double> * t, char selection)
+{
+  // Each lattice is split into tiles across threads, so tests run one at a time
+  TimeSweep("Lattice width", w, t, 1, false, [=](int width)
   {
-    #pragma omp parallel
+    return [=]()
     {
-      #pragma omp for
-      for (int j = 0; j < TESTS; ++j)
+      CellularPopulation pop(width, width, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(LARGE_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
+
+void TestLandscapePeriods(std::vector<int> * p, std::vector<double> * t, char selection, bool scheduled)
+{
+  // The landscape switches between two maps every period generations, either on a schedule or by
+  // stopping evolve to load the next map
+  TimeSweep("Landscape period", p, t, TESTS, true, [=](int period)
+  {
+    return [=]()
+    {
+      Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      if (scheduled)
       {
-        auto start = std::chrono::high_resolution_clock::now();
-        Population pop(DEFAULT_POPULATION_SIZE, m->at(i), DEFAULT_X, DEFAULT_Y);
-        pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+        for (int g = period; g < DEFAULT_GENERATIONS; g += period)
+          pop.schedule.addMap(g + 1, ((g / period) % 2) ? CONVERGING_FITNESS_MAP : DEFAULT_FITNESS_MAP);
         pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
-  
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-        iteration_times[j] = (duration.count() / 1000000000.0);
       }
-    }
-    t->at(i) = (std::accumulate(iteration_times.begin(), iteration_times.end(), 0.0) / TESTS);
+      else
+      {
+        for (int g = 0; g < DEFAULT_GENERATIONS; g += period)
+        {
+          if (g > 0)
+            pop.loadFitnessFunction(((g / period) % 2) ? CONVERGING_FITNESS_MAP : DEFAULT_FITNESS_MAP);
+          pop.evolve(std::min(period, DEFAULT_GENERATIONS - g), selection, DEFAULT_TOURNAMENT_SIZE);
+        }
+      }
+      return 1.0;
+    };
+  });
+}
 
-    std::cout << "Mutations " << m->at(i) << ": ";
-    PrintProgressBar(i, m->size());
-  }
-  std::cout << std::endl;
+void TestEnsembles(std::vector<int> * r, std::vector<double> * t, char selection)
+{
+  // One ensemble per size, reported as time per replicate to compare with separate populations
+  TimeSweep("Replicates", r, t, 1, false, [=](int replicates)
+  {
+    return [=]()
+    {
+      Ensemble ensemble(replicates, DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      ensemble.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      ensemble.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return double(replicates);
+    };
+  });
 }
 
-void TestFitnessMapSizes(std::vector<int> * f, std::vector<double> * t, char selection)
+void TestBucketedPopulations(std::vector<int> * p, std::vector<double> * t, bool bucket)
 {
-  t->clear();
-  t->resize(f->size());
+  // Batched tournaments on populations past the cache sizes, reported as time per child
+  TimeSweep("Bucketed population", p, t, 1, false, [=](int size)
+  {
+    Population pop(size, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+    pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+    pop.batched_rng = true;
+    pop.bucket_by_cell = bucket;
+    return [=, pop = std::move(pop)]() mutable
+    {
+      pop.evolve(LARGE_GENERATIONS, 't', DEFAULT_TOURNAMENT_SIZE);
+      return double(size) * LARGE_GENERATIONS;
+    };
+  });
+}
 
-  std::vector<double> iteration_times(TESTS);
+void TestSteadyStatePopulations(std::vector<int> * p, std::vector<double> * t, char selection)
+{
+  // In place steady state generations on large populations, reported as time per child
+  TimeSweep("Steady state population", p, t, 1, false, [=](int size)
+  {
+    Population pop(size, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+    pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+    pop.steady_state = true;
+    return [=, pop = std::move(pop)]() mutable
+    {
+      pop.evolve(LARGE_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return double(size) * LARGE_GENERATIONS;
+    };
+  });
+}
 
-  for (int i = 0; i < f->size(); ++i)
+void TestLandscapeSizes(std::vector<int> * f, std::vector<double> * t, char selection, bool memoize = false)
+{
+  // Procedural raised rings, no map files, so sizes go far past what a dense map could hold
+  TimeSweep("Landscape size", f, t, 1, false, [=](int size)
   {
-    std::string s = "./FitnessMaps/TestMaps/test_" + std::to_string(f->at(i)) + "x" + std::to_string(f->at(i)) + ".map";
-    #pragma omp parallel
+    Landscape landscape;
+    Landscape::named("raised_ring", size, size, landscape);
+    return [=]()
     {
-      #pragma omp for
-      for (int j = 0; j < TESTS; ++j)
-      {
-        auto start = std::chrono::high_resolution_clock::now();
-        Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
-        pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
-        pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.useLandscape(landscape, size, size, memoize);
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
 
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-        iteration_times[j] = (duration.count() / 1000000000.0);
-      }
-    }
-    t->at(i) = (std::accumulate(iteration_times.begin(), iteration_times.end(), 0.0) / TESTS);
+void TestCellLayouts(std::vector<int> * f, std::vector<double> * t, char selection, CellLayout layout)
+{
+  // Stored raised rings (dense, or tiled past MAX_DENSE_CELLS), timing only the evolution
+  TimeSweep("Layout " + std::to_string(layout) + " size", f, t, 1, false, [=](int size)
+  {
+    Landscape landscape;
+    Landscape::named("raised_ring", size, size, landscape);
+    Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, size / 2, size / 2);
+    pop.useLandscape(landscape, size, size);
+    pop.fitness_map.setStorage(FitnessMap::defaultStorage(size, size));
+    pop.setCellLayout(layout);
+    return [=, pop = std::move(pop)]() mutable
+    {
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
+
+void TestPaletteMaps(std::vector<int> * f, std::vector<double> * t, char selection, FitnessStorage storage)
+{
+  // Raised rings stored as doubles or as a palette of levels, timing only the evolution
+  std::vector<std::size_t> bytes(f->size());
+  TimeSweep("Storage " + std::to_string(storage) + " size", f, t, 1, false, [&](int size)
+  {
+    Landscape landscape;
+    Landscape::named("raised_ring", size, size, landscape);
+    Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, size / 2, size / 2);
+    pop.useLandscape(landscape, size, size);
+    pop.fitness_map.setStorage(storage);
+    bytes[std::find(f->begin(), f->end(), size) - f->begin()] = pop.fitness_map.storageBytes();
+    return [=, pop = std::move(pop)]() mutable
+    {
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+
+  for (int i = 0; i < f->size(); ++i)
+    std::cout << "  Storage " << storage << " size " << f->at(i) << ": " << bytes[i] << " bytes" << std::endl;
+}
+
+void TestRingRadii(std::vector<double> * r, std::vector<double> * t, char selection)
+{
+  // Parameter sweep without writing maps, ring of width 10 at each inner radius
+  TimeSweep("Ring radius", r, t, TESTS, true, [=](double radius)
+  {
+    Landscape landscape = Landscape::ring(50.0, 50.0, radius, radius + 10.0, 1.0, 10.0);
+    return [=]()
+    {
+      Population pop(DEFAULT_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.useLandscape(landscape, DEFAULT_GENE_SIZE, DEFAULT_GENE_SIZE);
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
 
-    std::cout << "Fitness map size " << (i + 1) << ": ";
-    PrintProgressBar(i, f->size());
+void TestSimdLevels(std::vector<int> * l, std::vector<double> * t, int tournament_size)
+{
+  // Same seed at every level, so each run does identical work
+  TimeSweep("SIMD level", l, t, 1, false, [=](int level)
+  {
+    return [=]()
+    {
+      Population pop(LARGE_POPULATION_SIZE, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.batched_rng = true;
+      pop.simd_level = SimdLevel(level);
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(LARGE_GENERATIONS, 't', tournament_size);
+      return 1.0;
+    };
+  });
+
+  // Report speedup over the scalar kernels
+  std::cout << "Tournament size " << tournament_size << std::endl;
+  for (int i = 0; i < l->size(); ++i)
+  {
+    std::cout << "  " << simdLevelName(SimdLevel(l->at(i))) << ": " << t->at(i) << "s, "
+              << t->at(0) / t->at(i) << "x" << std::endl;
   }
-  std::cout << std::endl;
 }
 
-int main()
+void TestCountPopulations(std::vector<uint64_t> * p, std::vector<double> * t, char selection)
+{
+  TimeSweep("Count population", p, t, TESTS, true, [=](uint64_t size)
+  {
+    return [=]()
+    {
+      CountPopulation pop(size, DEFAULT_MUTATION_RATE, DEFAULT_X, DEFAULT_Y);
+      pop.loadFitnessFunction(DEFAULT_FITNESS_MAP);
+      pop.evolve(DEFAULT_GENERATIONS, selection, DEFAULT_TOURNAMENT_SIZE);
+      return 1.0;
+    };
+  });
+}
+
+int main(int argc, char **argv)
 {
   // Times for each test
   std::vector<double> times;
 
-  // Population sizes to test
-  std::vector<int> pop_sizes;
-  for (int i = 0; i < 100; ++i)
+  // "bench" alone runs the original sweeps, "bench <mode>" runs one feature's sweeps instead, and
+  // "bench all" runs everything
+  std::string mode = (argc > 1) ? argv[1] : "";
+  if (!mode.empty() && mode != "all" && std::find(BENCH_MODES.begin(), BENCH_MODES.end(), mode) == BENCH_MODES.end())
+  {
+    std::cout << "Unknown mode " << mode << ", use one of: all";
+    for (auto &name : BENCH_MODES)
+      std::cout << " " << name;
+    std::cout << std::endl;
+    return 1;
+  }
+  auto runs = [&](std::string name) { return mode == name || mode == "all"; };
+  bool original = mode.empty() || mode == "all";
+
+  // Original sweeps: population sizes, generations, tournament sizes, mutation rates and map sizes
+  if (original)
+  {
+    // Population sizes to test
+    std::vector<int> pop_sizes;
+    for (int i = 0; i < 100; ++i)
+    {
+      pop_sizes.push_back((i+1) * 100);
+    }
+
+    // Run tournament selection tests
+    TestPopulations(&pop_sizes, &times, 't');
+    SaveResults(&pop_sizes, &times, "./BenchmarkData/population_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestPopulations(&pop_sizes, &times, 'r');
+    SaveResults(&pop_sizes, &times, "./BenchmarkData/population_results_roulette.txt");
+
+    // Generation sizes to test
+    std::vector<int> generations;
+    for (int i = 0; i < 100; ++i)
+    {
+      generations.push_back((i + 1) * 10);
+    }
+
+    // Run tournament selection tests
+    TestGenerations(&generations, &times, 't');
+    SaveResults(&generations, &times, "./BenchmarkData/generation_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestGenerations(&generations, &times, 'r');
+    SaveResults(&generations, &times, "./BenchmarkData/generation_results_roulette.txt");
+
+    // Tournament sizes to test
+    std::vector<int> tournament_sizes;
+    for (int i = 0; i < 100; ++i)
+    {
+      tournament_sizes.push_back((i + 1));
+    }
+
+    // Run tournament selection tests
+    TestTournamentSizes(&tournament_sizes, &times, 't');
+    SaveResults(&tournament_sizes, &times, "./BenchmarkData/tournament_results_tournament.txt");
+
+    // Mutation rates to test
+    std::vector<double> mutation_rates;
+    for (double i = 0.1; i < 1.0; i += 0.1)
+    {
+      mutation_rates.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestMutationRates(&mutation_rates, &times, 't');
+    SaveResults(&mutation_rates, &times, "./BenchmarkData/mutation_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestMutationRates(&mutation_rates, &times, 'r');
+    SaveResults(&mutation_rates, &times, "./BenchmarkData/mutation_results_roulette.txt");
+
+    // Fitness map sizes to test
+    std::vector<int> fitness_map_sizes;
+    for (int i = 0; i < 100; ++i)
+    {
+      fitness_map_sizes.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestFitnessMapSizes(&fitness_map_sizes, &times, 't');
+    SaveResults(&fitness_map_sizes, &times, "./BenchmarkData/fitness_map_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestFitnessMapSizes(&fitness_map_sizes, &times, 'r');
+    SaveResults(&fitness_map_sizes, &times, "./BenchmarkData/fitness_map_results_roulette.txt");
+  }
+
+  // Batched tournament kernels of each instruction set
+  if (runs("simd"))
   {
-    pop_sizes.push_back((i+1) * 100);
+    std::vector<int> simd_levels;
+    for (int i = SIMD_SCALAR; i <= detectSimdLevel(); ++i)
+    {
+      simd_levels.push_back(i);
+    }
+
+    std::vector<int> simd_tournament_sizes = {2, DEFAULT_TOURNAMENT_SIZE, 30};
+    for (int size : simd_tournament_sizes)
+    {
+      TestSimdLevels(&simd_levels, &times, size);
+      SaveResults(&simd_levels, &times, "./BenchmarkData/simd_results_tournament_" + std::to_string(size) + ".txt");
+    }
   }
 
-  // Run tournament selection tests
-  TestPopulations(&pop_sizes, &times, 't');
-  SaveResults(&pop_sizes, &times, "./BenchmarkData/population_results_tournament.txt");
+  // Stochastic universal sampling, rank and truncation selection
+  if (runs("selection"))
+  {
+    // Population sizes to test
+    std::vector<int> pop_sizes;
+    for (int i = 0; i < 100; ++i)
+    {
+      pop_sizes.push_back((i+1) * 100);
+    }
+
+    // Run stochastic universal sampling tests
+    TestPopulations(&pop_sizes, &times, 'u');
+    SaveResults(&pop_sizes, &times, "./BenchmarkData/population_results_universal.txt");
 
-  // Run roulette selection tests
-  TestPopulations(&pop_sizes, &times, 'r');
-  SaveResults(&pop_sizes, &times, "./BenchmarkData/population_results_roulette.txt");
+    // Run rank and truncation selection tests, both from one counting sort over fitness levels
+    TestPopulations(&pop_sizes, &times, 'k');
+    SaveResults(&pop_sizes, &times, "./BenchmarkData/population_results_rank.txt");
+    TestPopulations(&pop_sizes, &times, 'c');
+    SaveResults(&pop_sizes, &times, "./BenchmarkData/population_results_truncation.txt");
+  }
 
-  // Generation sizes to test
-  std::vector<int> generations;
-  for (int i = 0; i < 100; ++i)
+  // Stopping early once occupancy is stable
+  if (runs("stop"))
   {
-    generations.push_back((i + 1) * 10);
+    // Stable windows to test, 0 runs every generation
+    std::vector<int> stable_windows = {0, 25, 50, 100, 200, 400};
+
+    // Run tournament selection tests
+    TestStableWindows(&stable_windows, &times, 't');
+    SaveResults(&stable_windows, &times, "./BenchmarkData/stable_window_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestStableWindows(&stable_windows, &times, 'r');
+    SaveResults(&stable_windows, &times, "./BenchmarkData/stable_window_results_roulette.txt");
   }
 
-  // Run tournament selection tests
-  TestGenerations(&generations, &times, 't');
-  SaveResults(&generations, &times, "./BenchmarkData/generation_results_tournament.txt");
+  // Ranked tournaments
+  if (runs("ranked"))
+  {
+    // Tournament sizes to test
+    std::vector<int> tournament_sizes;
+    for (int i = 0; i < 100; ++i)
+    {
+      tournament_sizes.push_back((i + 1));
+    }
+
+    // Run ranked tournament selection tests
+    TestTournamentSizes(&tournament_sizes, &times, 't', true);
+    SaveResults(&tournament_sizes, &times, "./BenchmarkData/tournament_results_ranked.txt");
+  }
 
-  // Run roulette selection tests
-  TestGenerations(&generations, &times, 'r');
-  SaveResults(&generations, &times, "./BenchmarkData/generation_results_roulette.txt");
-  
-  // Tournament sizes to test
-  std::vector<int> tournament_sizes;
-  for (int i = 0; i < 100; ++i)
+  // Batched RNG with geometric mutation gaps
+  if (runs("batched"))
   {
-    tournament_sizes.push_back((i + 1));
+    // Low mutation rates, where batched mode skips most of the mutation draws
+    std::vector<double> low_mutation_rates;
+    for (double i = 0.0001; i < 0.2; i *= 10)
+    {
+      low_mutation_rates.push_back(i);
+    }
+
+    // Run tournament selection tests, per child coin flips then geometric gaps
+    TestMutationRates(&low_mutation_rates, &times, 't');
+    SaveResults(&low_mutation_rates, &times, "./BenchmarkData/low_mutation_results_tournament.txt");
+    TestMutationRates(&low_mutation_rates, &times, 't', true);
+    SaveResults(&low_mutation_rates, &times, "./BenchmarkData/low_mutation_results_batched_tournament.txt");
+
+    // Run roulette selection tests, per child coin flips then geometric gaps
+    TestMutationRates(&low_mutation_rates, &times, 'r');
+    SaveResults(&low_mutation_rates, &times, "./BenchmarkData/low_mutation_results_roulette.txt");
+    TestMutationRates(&low_mutation_rates, &times, 'r', true);
+    SaveResults(&low_mutation_rates, &times, "./BenchmarkData/low_mutation_results_batched_roulette.txt");
   }
 
-  // Run tournament selection tests
-  TestTournamentSizes(&tournament_sizes, &times, 't');
-  SaveResults(&tournament_sizes, &times, "./BenchmarkData/tournament_results_tournament.txt");
+  // Fast-forward over quiescent generations
+  if (runs("fastforward"))
+  {
+    // Very low mutation rates, where populations sit on one gene pair and fast-forward jumps to the next mutant
+    std::vector<double> rare_mutation_rates;
+    for (double i = 0.0000001; i < 0.0002; i *= 10)
+    {
+      rare_mutation_rates.push_back(i);
+    }
+
+    // Run tournament selection tests, every generation then fast-forward
+    TestFastForwardRates(&rare_mutation_rates, &times, 't', false);
+    SaveResults(&rare_mutation_rates, &times, "./BenchmarkData/rare_mutation_results_tournament.txt");
+    TestFastForwardRates(&rare_mutation_rates, &times, 't', true);
+    SaveResults(&rare_mutation_rates, &times, "./BenchmarkData/rare_mutation_results_fast_forward_tournament.txt");
+
+    // Run roulette selection tests, every generation then fast-forward
+    TestFastForwardRates(&rare_mutation_rates, &times, 'r', false);
+    SaveResults(&rare_mutation_rates, &times, "./BenchmarkData/rare_mutation_results_roulette.txt");
+    TestFastForwardRates(&rare_mutation_rates, &times, 'r', true);
+    SaveResults(&rare_mutation_rates, &times, "./BenchmarkData/rare_mutation_results_fast_forward_roulette.txt");
+
+    // Usual mutation rates, where tournament populations only get nearly monomorphic
+    std::vector<double> usual_mutation_rates;
+    for (double i = 0.0001; i < 0.02; i *= 10)
+    {
+      usual_mutation_rates.push_back(i);
+    }
+
+    // Run tournament selection tests, every generation then fast-forward from a nearly monomorphic population
+    TestFastForwardRates(&usual_mutation_rates, &times, 't', false);
+    SaveResults(&usual_mutation_rates, &times, "./BenchmarkData/usual_mutation_results_tournament.txt");
+    TestFastForwardRates(&usual_mutation_rates, &times, 't', true, NEARLY_MONOMORPHIC_SHARE);
+    SaveResults(&usual_mutation_rates, &times, "./BenchmarkData/usual_mutation_results_fast_forward_tournament.txt");
+  }
 
-  // Mutation rates to test
-  std::vector<double> mutation_rates;
-  for (double i = 0.1; i < 1.0; i += 0.1)
+  // Batched tournaments picking runs of organisms per cell
+  if (runs("bucket"))
   {
-    mutation_rates.push_back(i);
+    // Large population sizes to test, 10^5 to 1.6 * 10^7
+    std::vector<int> large_pop_sizes;
+    for (int i = 100000; i <= 16000000; i *= 2)
+    {
+      large_pop_sizes.push_back(i);
+    }
+
+    // Run batched tournament tests, picking organisms then picking runs of organisms per cell
+    TestBucketedPopulations(&large_pop_sizes, &times, false);
+    SaveResults(&large_pop_sizes, &times, "./BenchmarkData/large_population_results_batched.txt");
+    TestBucketedPopulations(&large_pop_sizes, &times, true);
+    SaveResults(&large_pop_sizes, &times, "./BenchmarkData/large_population_results_bucketed.txt");
   }
 
-  // Run tournament selection tests
-  TestMutationRates(&mutation_rates, &times, 't');
-  SaveResults(&mutation_rates, &times, "./BenchmarkData/mutation_results_tournament.txt");
+  // Steady state generations
+  if (runs("steady"))
+  {
+    // Large population sizes to test, 10^5 to 1.6 * 10^7
+    std::vector<int> large_pop_sizes;
+    for (int i = 100000; i <= 16000000; i *= 2)
+    {
+      large_pop_sizes.push_back(i);
+    }
 
-  // Run roulette selection tests
-  TestMutationRates(&mutation_rates, &times, 'r');
-  SaveResults(&mutation_rates, &times, "./BenchmarkData/mutation_results_roulette.txt");
+    // Run steady state tests, one population array instead of two
+    TestSteadyStatePopulations(&large_pop_sizes, &times, 't');
+    SaveResults(&large_pop_sizes, &times, "./BenchmarkData/large_population_results_steady_state_tournament.txt");
+    TestSteadyStatePopulations(&large_pop_sizes, &times, 'r');
+    SaveResults(&large_pop_sizes, &times, "./BenchmarkData/large_population_results_steady_state_roulette.txt");
+  }
 
-  // Fitness map sizes to test
-  std::vector<int> fitness_map_sizes;
-  for (int i = 0; i < 100; ++i)
+  // Procedural landscapes
+  if (runs("landscape"))
   {
-    fitness_map_sizes.push_back(i);
+    // Procedural landscape sizes to test, 100x100 up to the largest map cells can address
+    std::vector<int> landscape_sizes = {100, 1000, 10000, 65536};
+
+    // Run tournament selection tests, evaluated every lookup then memoized by tile
+    TestLandscapeSizes(&landscape_sizes, &times, 't');
+    SaveResults(&landscape_sizes, &times, "./BenchmarkData/landscape_results_tournament.txt");
+    TestLandscapeSizes(&landscape_sizes, &times, 't', true);
+    SaveResults(&landscape_sizes, &times, "./BenchmarkData/landscape_results_memoized_tournament.txt");
+
+    // Run roulette selection tests
+    TestLandscapeSizes(&landscape_sizes, &times, 'r');
+    SaveResults(&landscape_sizes, &times, "./BenchmarkData/landscape_results_roulette.txt");
+
+    // Ring radii to test
+    std::vector<double> ring_radii;
+    for (double i = 0.0; i <= 40.0; i += 5.0)
+    {
+      ring_radii.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestRingRadii(&ring_radii, &times, 't');
+    SaveResults(&ring_radii, &times, "./BenchmarkData/ring_radius_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestRingRadii(&ring_radii, &times, 'r');
+    SaveResults(&ring_radii, &times, "./BenchmarkData/ring_radius_results_roulette.txt");
   }
 
-  // Run tournament selection tests
-  TestFitnessMapSizes(&fitness_map_sizes, &times, 't');
-  SaveResults(&fitness_map_sizes, &times, "./BenchmarkData/fitness_map_results_tournament.txt");
+  // Row-major and Morton cell layouts
+  if (runs("layout"))
+  {
+    // Stored map sizes to test, 1024x1024 to 8192x8192
+    std::vector<int> layout_sizes;
+    for (int i = 1024; i <= 8192; i *= 2)
+    {
+      layout_sizes.push_back(i);
+    }
+
+    // Run tournament selection tests, row-major then Morton cells
+    TestCellLayouts(&layout_sizes, &times, 't', LAYOUT_ROW_MAJOR);
+    SaveResults(&layout_sizes, &times, "./BenchmarkData/layout_results_row_major_tournament.txt");
+    TestCellLayouts(&layout_sizes, &times, 't', LAYOUT_MORTON);
+    SaveResults(&layout_sizes, &times, "./BenchmarkData/layout_results_morton_tournament.txt");
+
+    // Run roulette selection tests, row-major then Morton cells
+    TestCellLayouts(&layout_sizes, &times, 'r', LAYOUT_ROW_MAJOR);
+    SaveResults(&layout_sizes, &times, "./BenchmarkData/layout_results_row_major_roulette.txt");
+    TestCellLayouts(&layout_sizes, &times, 'r', LAYOUT_MORTON);
+    SaveResults(&layout_sizes, &times, "./BenchmarkData/layout_results_morton_roulette.txt");
+  }
+
+  // Palette map storage
+  if (runs("palette"))
+  {
+    // Dense map sizes to test, 512x512 to 4096x4096
+    std::vector<int> palette_sizes;
+    for (int i = 512; i <= 4096; i *= 2)
+    {
+      palette_sizes.push_back(i);
+    }
+
+    // Run tournament selection tests, doubles then palette levels
+    TestPaletteMaps(&palette_sizes, &times, 't', STORAGE_DENSE);
+    SaveResults(&palette_sizes, &times, "./BenchmarkData/palette_results_dense_tournament.txt");
+    TestPaletteMaps(&palette_sizes, &times, 't', STORAGE_PALETTE);
+    SaveResults(&palette_sizes, &times, "./BenchmarkData/palette_results_palette_tournament.txt");
+
+    // Run roulette selection tests, doubles then palette levels
+    TestPaletteMaps(&palette_sizes, &times, 'r', STORAGE_DENSE);
+    SaveResults(&palette_sizes, &times, "./BenchmarkData/palette_results_dense_roulette.txt");
+    TestPaletteMaps(&palette_sizes, &times, 'r', STORAGE_PALETTE);
+    SaveResults(&palette_sizes, &times, "./BenchmarkData/palette_results_palette_roulette.txt");
+  }
+
+  // Aggregated populations
+  if (runs("count"))
+  {
+    // Aggregated population sizes to test, 10^2 to 10^10
+    std::vector<uint64_t> count_pop_sizes;
+    for (uint64_t i = 100; i <= 10000000000; i *= 10)
+    {
+      count_pop_sizes.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestCountPopulations(&count_pop_sizes, &times, 't');
+    SaveResults(&count_pop_sizes, &times, "./BenchmarkData/count_population_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestCountPopulations(&count_pop_sizes, &times, 'r');
+    SaveResults(&count_pop_sizes, &times, "./BenchmarkData/count_population_results_roulette.txt");
+  }
 
-  // Run roulette selection tests
-  TestFitnessMapSizes(&fitness_map_sizes, &times, 'r');
-  SaveResults(&fitness_map_sizes, &times, "./BenchmarkData/fitness_map_results_roulette.txt");
+  // Moran populations
+  if (runs("moran"))
+  {
+    // Moran population sizes to test, 10^2 to 10^6
+    std::vector<uint64_t> moran_pop_sizes;
+    for (uint64_t i = 100; i <= 1000000; i *= 10)
+    {
+      moran_pop_sizes.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestMoranPopulations(&moran_pop_sizes, &times, 't');
+    SaveResults(&moran_pop_sizes, &times, "./BenchmarkData/moran_population_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestMoranPopulations(&moran_pop_sizes, &times, 'r');
+    SaveResults(&moran_pop_sizes, &times, "./BenchmarkData/moran_population_results_roulette.txt");
+  }
+
+  // Infinite populations
+  if (runs("infinite"))
+  {
+    // Map sizes to test the infinite population on, 100x100 to 3200x3200
+    std::vector<int> infinite_map_sizes;
+    for (int i = 100; i <= 3200; i *= 2)
+    {
+      infinite_map_sizes.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestInfinitePopulations(&infinite_map_sizes, &times, 't');
+    SaveResults(&infinite_map_sizes, &times, "./BenchmarkData/infinite_population_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestInfinitePopulations(&infinite_map_sizes, &times, 'r');
+    SaveResults(&infinite_map_sizes, &times, "./BenchmarkData/infinite_population_results_roulette.txt");
+  }
+
+  // Parallel generations
+  if (runs("threads"))
+  {
+    // Thread counts to test
+    std::vector<int> thread_counts;
+    for (int i = 1; i <= omp_get_max_threads(); i *= 2)
+    {
+      thread_counts.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestThreadCounts(&thread_counts, &times, 't');
+    SaveResults(&thread_counts, &times, "./BenchmarkData/thread_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestThreadCounts(&thread_counts, &times, 'r');
+    SaveResults(&thread_counts, &times, "./BenchmarkData/thread_results_roulette.txt");
+  }
+
+  // Island models
+  if (runs("islands"))
+  {
+    // Island counts to test, up to one per thread
+    std::vector<int> island_counts;
+    for (int i = 1; i <= omp_get_max_threads(); i *= 2)
+    {
+      island_counts.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestIslandCounts(&island_counts, &times, 't');
+    SaveResults(&island_counts, &times, "./BenchmarkData/island_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestIslandCounts(&island_counts, &times, 'r');
+    SaveResults(&island_counts, &times, "./BenchmarkData/island_results_roulette.txt");
+  }
+
+  // Cellular populations
+  if (runs("cellular"))
+  {
+    // Lattice widths to test, up to LARGE_POPULATION_SIZE slots
+    std::vector<int> lattice_widths;
+    for (int i = 100; i <= 1000; i += 100)
+    {
+      lattice_widths.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestCellularLattices(&lattice_widths, &times, 't');
+    SaveResults(&lattice_widths, &times, "./BenchmarkData/cellular_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestCellularLattices(&lattice_widths, &times, 'r');
+    SaveResults(&lattice_widths, &times, "./BenchmarkData/cellular_results_roulette.txt");
+  }
+
+  // Landscape schedules
+  if (runs("schedule"))
+  {
+    // Generations between landscape switches to test
+    std::vector<int> landscape_periods;
+    for (int i = 1; i <= DEFAULT_GENERATIONS; i *= 10)
+    {
+      landscape_periods.push_back(i);
+    }
+
+    // Run tests with reloads between evolve calls, then with a schedule
+    TestLandscapePeriods(&landscape_periods, &times, 't', false);
+    SaveResults(&landscape_periods, &times, "./BenchmarkData/landscape_reload_results_tournament.txt");
+    TestLandscapePeriods(&landscape_periods, &times, 't', true);
+    SaveResults(&landscape_periods, &times, "./BenchmarkData/landscape_schedule_results_tournament.txt");
+  }
+
+  // Ensembles
+  if (runs("ensemble"))
+  {
+    // Ensemble replicate counts to test
+    std::vector<int> replicate_counts;
+    for (int i = 1; i <= TESTS; i *= 2)
+    {
+      replicate_counts.push_back(i);
+    }
+
+    // Run tournament selection tests
+    TestEnsembles(&replicate_counts, &times, 't');
+    SaveResults(&replicate_counts, &times, "./BenchmarkData/ensemble_results_tournament.txt");
+
+    // Run roulette selection tests
+    TestEnsembles(&replicate_counts, &times, 'r');
+    SaveResults(&replicate_counts, &times, "./BenchmarkData/ensemble_results_roulette.txt");
+  }
 
   return 0;
 }
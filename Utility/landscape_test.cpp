@@ -0,0 +1,49 @@
+#include "fitness_map.h"
+#include <string>
+#include <iostream>
+
+// Built in landscapes and the FitnessMaps/ files they reproduce (size prefix, name)
+const std::string LANDSCAPE_FILES[][2] = {
+  {"10x10", "flat"},
+  {"10x10", "ring"},
+  {"10x10", "corner"},
+  {"10x10", "big_vs_small_equal_peaks"},
+  {"10x10", "big_vs_small_unequal_peaks"},
+  {"100x100", "flat"},
+  {"100x100", "major_slope"},
+  {"100x100", "slight_slope"},
+  {"100x100", "ring"},
+  {"100x100", "raised_ring"},
+  {"100x100", "comb"},
+  {"100x100", "big_vs_small_equal_peaks"},
+  {"100x100", "big_vs_small_unequal_peaks"}
+};
+
+/*
+ * Compares each built in landscape against its map file cell by cell, run from the repo root
+ * Returns: 0 if every landscape matches its file
+ */
+int main()
+{
+  int failed = 0;
+  for (auto &file : LANDSCAPE_FILES)
+  {
+    std::string path = "./FitnessMaps/" + file[0] + "_" + file[1] + ".map";
+    FitnessMap map;
+    Landscape landscape;
+    if (!map.load(path) || !Landscape::named(file[1], map.xlim, map.ylim, landscape))
+    {
+      std::cout << path << ": can't compare" << std::endl;
+      ++failed;
+      continue;
+    }
+
+    int differ = 0;
+    for (int y = 0; y < map.ylim; ++y)
+      for (int x = 0; x < map.xlim; ++x)
+        differ += (map.get(x, y) != landscape.value(x, y));
+    std::cout << path << ": " << differ << " cells differ" << std::endl;
+    failed += (differ > 0);
+  }
+  return (failed > 0) ? 1 : 0;
+}
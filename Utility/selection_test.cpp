@@ -0,0 +1,179 @@
+#include "evolution.h"
+#include "alias_table.h"
+#include "engine.h"
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iostream>
+
+const int SELECTION_TEST_SEED = 777;
+const int SELECTION_TEST_N = 1000; // Parents per generation
+const int SELECTION_TEST_GENERATIONS = 400; // Generations of children counted per case
+const int SELECTION_TEST_LEVELS = 10; // Fitness levels of the test map, 1 to 10 along x
+const double MAX_DEVIATION = 5.0; // Largest deviation from the expected count allowed, in standard deviations
+
+/*
+ * Function to print a setting for a case name
+ * Arguments: value
+ * Returns: Value as a short string
+ */
+std::string Format(double value)
+{
+  std::ostringstream s;
+  s << value;
+  return s.str();
+}
+
+/*
+ * Function to compare observed counts against the expected chance of each outcome
+ * Arguments: name of the case, observed counts, expected chances (summing to 1)
+ * Returns: True if every count is within MAX_DEVIATION standard deviations of its expectation
+ */
+bool CheckCounts(std::string name, const std::vector<uint64_t> &counts, const std::vector<double> &chances)
+{
+  uint64_t draws = 0;
+  for (uint64_t c : counts)
+    draws += c;
+
+  double worst = 0.0;
+  bool impossible = false; // A count on an outcome that can't happen
+  for (std::size_t i = 0; i < counts.size(); ++i)
+  {
+    double expected = draws * chances[i];
+    double deviation = std::sqrt(expected * (1 - chances[i]));
+    if (deviation > 0)
+      worst = std::max(worst, std::abs(counts[i] - expected) / deviation);
+    else if (double(counts[i]) != expected)
+      impossible = true;
+  }
+
+  bool ok = !impossible && worst <= MAX_DEVIATION;
+  std::cout << name << ": " << (ok ? "ok" : "FAILED") << " (largest deviation " << worst << " sd"
+            << (impossible ? ", impossible outcome drawn" : "") << ")" << std::endl;
+  return ok;
+}
+
+/*
+ * Function to set up a population spread unevenly over the test map's levels, more organisms on
+ * lower levels
+ * Arguments: None
+ * Returns: Population (no mutations) with its parents saved as the initial population
+ */
+Population LevelPopulation()
+{
+  Population p(SELECTION_TEST_N, 0.0, 0, 0);
+  for (int x = 0; x < SELECTION_TEST_LEVELS; ++x)
+    for (int y = 0; y < p.fitness_map.ylim; ++y)
+      p.fitness_map.set(x, y, 1.0 + x);
+  for (int i = 0; i < p.n; ++i)
+  {
+    double u = (i + 0.5) / p.n;
+    p.pop1[i].cell = p.fitness_map.toCell(int(SELECTION_TEST_LEVELS * u * u), 0);
+  }
+  p.newInitPop();
+  return p;
+}
+
+/*
+ * Function to count the level of every child over many single generations from the same parents,
+ * each with its own seed
+ * Arguments: population from LevelPopulation, flag for selection method, tournament size
+ * Returns: Children per level
+ */
+std::vector<uint64_t> ChildLevels(Population &p, char selection, int t)
+{
+  std::vector<uint64_t> counts(SELECTION_TEST_LEVELS, 0);
+  for (int g = 0; g < SELECTION_TEST_GENERATIONS; ++g)
+  {
+    // Counter-based streams are keyed by seed and generation, and reset takes gen back to 0
+    p.reset();
+    p.setSeed(SELECTION_TEST_SEED + g);
+    p.evolve(1, selection, t, false, "./TestData/");
+    AlignedArray<Organism> &children = p.first_pop ? p.pop1 : p.pop2;
+    for (int i = 0; i < p.n; ++i)
+      ++counts[p.fitness_map.getX(children[i].cell)];
+  }
+  return counts;
+}
+
+/*
+ * Function to get the chance a parent comes from each level of LevelPopulation, given the chance
+ * share(x) that a pick is in the lowest x of the ranking
+ * Arguments: rank policy
+ * Returns: Chance of each level
+ */
+template <typename Rank>
+std::vector<double> LevelChances(const Rank &rank)
+{
+  Population p = LevelPopulation();
+  std::vector<int> below(SELECTION_TEST_LEVELS + 1, 0); // Organisms below each level
+  for (int i = 0; i < p.n; ++i)
+    ++below[p.fitness_map.getX(p.pop1[i].cell) + 1];
+  for (int l = 0; l < SELECTION_TEST_LEVELS; ++l)
+    below[l + 1] += below[l];
+
+  std::vector<double> chances(SELECTION_TEST_LEVELS);
+  for (int l = 0; l < SELECTION_TEST_LEVELS; ++l)
+    chances[l] = rank.share(double(below[l + 1]) / p.n) - rank.share(double(below[l]) / p.n);
+  return chances;
+}
+
+/*
+ * Checks that the different ways of making a generation pick parents with the intended chances:
+ * classic, ranked and batched tournaments against the best of t uniform picks, linear rank and
+ * truncation against their share functions, and alias table draws against their weights
+ * Returns: 0 if every case is within MAX_DEVIATION standard deviations
+ */
+int main()
+{
+  bool ok = true;
+
+  for (int t : {2, 7, 100})
+  {
+    std::vector<double> chances = LevelChances(TournamentRank{double(t), 1.0 / t});
+    std::string size = " t=" + std::to_string(t);
+
+    Population classic = LevelPopulation();
+    ok &= CheckCounts("Classic tournament" + size, ChildLevels(classic, 't', t), chances);
+
+    Population ranked = LevelPopulation();
+    ranked.ranked_tournament = true;
+    ok &= CheckCounts("Ranked tournament" + size, ChildLevels(ranked, 't', t), chances);
+
+    Population batched = LevelPopulation();
+    batched.batched_rng = true;
+    ok &= CheckCounts("Batched tournament" + size, ChildLevels(batched, 't', t), chances);
+  }
+
+  for (double pressure : {1.0, 1.5, 2.0})
+  {
+    Population p = LevelPopulation();
+    p.rank_pressure = pressure;
+    ok &= CheckCounts("Linear rank pressure=" + Format(pressure), ChildLevels(p, 'k', 0),
+                      LevelChances(LinearRank{pressure}));
+  }
+
+  for (double kept : {0.1, 0.5, 1.0})
+  {
+    Population p = LevelPopulation();
+    p.truncation_share = kept;
+    ok &= CheckCounts("Truncation share=" + Format(kept), ChildLevels(p, 'c', 0),
+                      LevelChances(TruncationRank{kept}));
+  }
+
+  // Uneven weights with empty slots, drawn directly
+  std::vector<double> weights = {0.0, 1.0, 2.5, 0.0, 10.0, 0.25, 3.0, 7.0, 0.0, 1.0, 5.0, 0.5};
+  AliasTable table;
+  double total = table.build(weights.data(), weights.size());
+  std::vector<double> chances(weights.size());
+  for (std::size_t i = 0; i < weights.size(); ++i)
+    chances[i] = weights[i] / total;
+  std::vector<uint64_t> counts(weights.size(), 0);
+  emp::Random rng(SELECTION_TEST_SEED);
+  for (int i = 0; i < SELECTION_TEST_N * SELECTION_TEST_GENERATIONS; ++i)
+    ++counts[table.sample(rng)];
+  ok &= CheckCounts("Alias table", counts, chances);
+
+  return ok ? 0 : 1;
+}
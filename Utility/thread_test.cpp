@@ -0,0 +1,113 @@
+#include "evolution.h"
+#include "ensemble.h"
+#include "cellular_population.h"
+#include <string>
+#include <vector>
+#include <iostream>
+
+const std::string THREAD_TEST_MAP = "./FitnessMaps/100x100_raised_ring.map";
+const int THREAD_TEST_SEED = 12345;
+const int THREAD_TEST_GENERATIONS = 50;
+const std::vector<int> THREAD_COUNTS = {1, 2, 4};
+
+/*
+ * Function to run a parallel Population and list where its organisms end up
+ * Arguments: thread count, flag for selection method, flag for the batched RNG
+ * Returns: Cell of every organism
+ */
+std::vector<uint32_t> RunPopulation(int threads, char selection, bool batched)
+{
+  Population p(5000, 0.05, 50, 30);
+  p.loadFitnessFunction(THREAD_TEST_MAP);
+  p.setSeed(THREAD_TEST_SEED);
+  p.parallel = true;
+  p.threads = threads;
+  p.batched_rng = batched;
+  p.evolve(THREAD_TEST_GENERATIONS, selection, 7, false, "./TestData/");
+
+  AlignedArray<Organism> &pop = p.first_pop ? p.pop1 : p.pop2;
+  std::vector<uint32_t> cells(p.n);
+  for (int i = 0; i < p.n; ++i)
+    cells[i] = pop[i].cell;
+  return cells;
+}
+
+/*
+ * Function to run a parallel Ensemble and list where its organisms end up
+ * Arguments: thread count, flag for selection method
+ * Returns: Cell of every organism of every replicate
+ */
+std::vector<uint32_t> RunEnsemble(int threads, char selection)
+{
+  Ensemble e(8, 1000, 0.05, 50, 30);
+  e.loadFitnessFunction(THREAD_TEST_MAP);
+  e.setSeed(THREAD_TEST_SEED);
+  e.parallel = true;
+  e.threads = threads;
+  e.evolve(THREAD_TEST_GENERATIONS, selection, 7, false, "./TestData/");
+
+  std::vector<uint32_t> cells;
+  for (int r = 0; r < e.replicates; ++r)
+    for (int i = 0; i < e.n; ++i)
+      cells.push_back(e.cell(r, i));
+  return cells;
+}
+
+/*
+ * Function to run a CellularPopulation and list where its organisms end up
+ * Arguments: thread count, flag for selection method
+ * Returns: Cell of every lattice slot
+ */
+std::vector<uint32_t> RunCellular(int threads, char selection)
+{
+  CellularPopulation c(100, 60, 0.05, 50, 30);
+  c.loadFitnessFunction(THREAD_TEST_MAP);
+  c.setSeed(THREAD_TEST_SEED);
+  c.threads = threads;
+  c.tile_size = 16; // Several tiles per thread
+  c.evolve(THREAD_TEST_GENERATIONS, selection, 3, false, "./TestData/");
+
+  AlignedArray<Organism> &lattice = c.first_pop ? c.lattice1 : c.lattice2;
+  std::vector<uint32_t> cells(c.n);
+  for (int i = 0; i < c.n; ++i)
+    cells[i] = lattice[i].cell;
+  return cells;
+}
+
+/*
+ * Function to compare runs on each thread count against the single thread run
+ * Arguments: name of the case, run for a thread count
+ * Returns: True if every run ended with exactly the same organisms
+ */
+template <typename Run>
+bool CheckThreadCounts(std::string name, Run run)
+{
+  std::vector<uint32_t> expected = run(THREAD_COUNTS[0]);
+  bool same = true;
+  for (std::size_t i = 1; i < THREAD_COUNTS.size(); ++i)
+  {
+    bool match = (run(THREAD_COUNTS[i]) == expected);
+    std::cout << name << " on " << THREAD_COUNTS[i] << " threads: " << (match ? "same" : "DIFFERENT") << std::endl;
+    same = same && match;
+  }
+  return same;
+}
+
+/*
+ * Runs each parallel engine on 1, 2 and 4 threads with the same seed, their final populations must
+ * be identical. Run from the repo root.
+ * Returns: 0 if every engine matched
+ */
+int main()
+{
+  bool same = true;
+  for (char selection : {'t', 'r'})
+  {
+    std::string method(1, selection);
+    same &= CheckThreadCounts("Population " + method, [&](int threads) { return RunPopulation(threads, selection, false); });
+    same &= CheckThreadCounts("Population batched " + method, [&](int threads) { return RunPopulation(threads, selection, true); });
+    same &= CheckThreadCounts("Ensemble " + method, [&](int threads) { return RunEnsemble(threads, selection); });
+    same &= CheckThreadCounts("CellularPopulation " + method, [&](int threads) { return RunCellular(threads, selection); });
+  }
+  return same ? 0 : 1;
+}
@@ -105,7 +105,7 @@ public:
       [this]()
       {
         for (auto &p : selected)
-          pop.fitness_map[p.second][p.first] = entryValue;
+          pop.fitness_map.set(p.first, p.second, entryValue);
         CreateColorMap();
         DrawSimulationMap();
       },
@@ -154,7 +154,7 @@ public:
   // Function to select tile
   void MouseDown(int x, int y)
   {
-    double unit = csize / pop.xlim;
+    double unit = csize / pop.fitness_map.xlim;
     
     // Set start tile
     startTileX = (x / unit);
@@ -164,7 +164,7 @@ public:
   // Function to select tile
   void MouseUp(int x, int y)
   {
-    double unit = csize / pop.xlim;
+    double unit = csize / pop.fitness_map.xlim;
     
     // Set end tile
     endTileX = (x / unit);
@@ -195,11 +195,11 @@ public:
     colorMap.clear();
 
     // Add all fitness levels (std::map will auto sort)
-    for (int i = 0; i < pop.xlim; ++i)
+    for (int i = 0; i < pop.fitness_map.xlim; ++i)
     {
-      for (int j = 0; j < pop.ylim; ++j)
+      for (int j = 0; j < pop.fitness_map.ylim; ++j)
       {
-        colorMap.insert(std::pair<int, std::string>(pop.fitness_map[j][i], "black"));
+        colorMap.insert(std::pair<int, std::string>(pop.fitness_map.get(i, j), "black"));
       }
     }
     
@@ -231,12 +231,12 @@ public:
   {
     canvas.Clear();
 
-    double unit = csize / pop.xlim;
+    double unit = csize / pop.fitness_map.xlim;
     std::string borderColor = "black";
 
-    for (int i = 0; i < pop.xlim; ++i)
+    for (int i = 0; i < pop.fitness_map.xlim; ++i)
     {
-      for (int j = 0; j < pop.ylim; ++j)
+      for (int j = 0; j < pop.fitness_map.ylim; ++j)
       {
         borderColor = "grey";
 
@@ -244,7 +244,7 @@ public:
         if (selected.contains(std::pair<int, int>(i, j)))
           canvas.Rect(unit * i, unit * j, unit, unit, "white", "black");
         else // Draw grid tile using assigned color otherwise
-          canvas.Rect(unit * i, unit * j, unit, unit, colorMap[pop.fitness_map[j][i]], "black");
+          canvas.Rect(unit * i, unit * j, unit, unit, colorMap[pop.fitness_map.get(i, j)], "black");
       }
     }
   }
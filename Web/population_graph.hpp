@@ -11,6 +11,9 @@
 
 namespace UI = emp::web;
 
+constexpr int MAX_GENE_SIZE = 100; // Largest fitness map the editor will draw
+constexpr int MAX_POP_SIZE = 10000; // Largest population the page will animate
+
 class PopulationGraph : public UI::Animate
 {
 private:
@@ -38,7 +41,7 @@ private:
   int colorFitnessValue; // Value of fitness being assigned to a color
   bool colorHexValid; // Check for if the input to colorHexValue is valid
   bool colorFitnessValid; // Check for if the input to colorHexValue is valid
-  std::string selectionMethod = "r"; // Selection method parameter: "r" = roulette, "t" = tournament
+  std::string selectionMethod = "r"; // Selection method parameter: "r" = roulette, "t" = tournament, "u" = universal sampling, "k" = rank, "c" = truncation
   int tournamentSize = 7; // Tournament size
   int tournamentSizeEntry; // Tournament size in the entry area, used to update tournamentSize
 
@@ -241,15 +244,9 @@ public:
         {
           // Determine which population storage is in use
           if (pop.first_pop)
-          {
-            pop.pop1[i].x = itr->first;
-            pop.pop1[i].y = itr->second;
-          }
+            pop.pop1[i].cell = pop.fitness_map.toCell(itr->first, itr->second);
           else
-          {
-            pop.pop2[i].x = itr->first;
-            pop.pop2[i].y = itr->second;
-          }
+            pop.pop2[i].cell = pop.fitness_map.toCell(itr->first, itr->second);
 
           // Cycle through selected tiles for distribution
           itr++;
@@ -291,6 +288,9 @@ public:
     selectionMethodSelector = UI::Selector("selection_method_selector");
     selectionMethodSelector.SetOption("Roulette");
     selectionMethodSelector.SetOption("Tournament");
+    selectionMethodSelector.SetOption("Universal sampling");
+    selectionMethodSelector.SetOption("Rank");
+    selectionMethodSelector.SetOption("Truncation");
 
     // Used to set option from selectionMethodSelector
     selectionMethodButton = UI::Button(
@@ -308,6 +308,18 @@ public:
           selectionMethod = 't';
           selectionText << "Tournament (" << tournamentSize << ")" << "<br>";
           break;
+        case 2:
+          selectionMethod = 'u';
+          selectionText << "Universal sampling" << "<br>";
+          break;
+        case 3:
+          selectionMethod = 'k';
+          selectionText << "Rank (" << pop.rank_pressure << ")" << "<br>";
+          break;
+        case 4:
+          selectionMethod = 'c';
+          selectionText << "Truncation (" << pop.truncation_share << ")" << "<br>";
+          break;
         default:
           selectionMethod = 'r';
           selectionText << "Roulette" << "<br>";
@@ -407,18 +419,13 @@ public:
       );
     fitnessSizeEntryTA.SetSize(80, 20);
     fitnessSizeEntryTA.SetResizableOff();
-    fitnessSizeEntryTA.SetText(std::to_string(pop.xlim));
+    fitnessSizeEntryTA.SetText(std::to_string(pop.fitness_map.xlim));
 
     fitnessSizeEntryButton = UI::Button(
       [this]()
       {
-        // Set all new tiles to 0. If reducing, doesn't matter and will be skipped
-        for (int i = 0; i < fitnessSizeEntryValue; ++i)
-          for (int j = 0; j < fitnessSizeEntryValue; ++j)
-            if (i >= pop.xlim || j >= pop.ylim)
-              pop.fitness_map[j][i] = 0.0;
-        pop.xlim = fitnessSizeEntryValue;
-        pop.ylim = fitnessSizeEntryValue;
+        // New tiles are set to 0, organisms are kept on the same genes
+        pop.resizeFitnessMap(fitnessSizeEntryValue, fitnessSizeEntryValue);
         CreateColorMap();
         Redraw();
       },
@@ -540,10 +547,10 @@ public:
       [this]()
       {
         // Set all instances of selected color to colorFitnessValue
-        for (int i = 0; i < pop.xlim; ++i)
-          for (int j = 0; j < pop.ylim; ++j)
-            if (pop.fitness_map[j][i] == selectedColorFitness)
-              pop.fitness_map[j][i] = colorFitnessValue;
+        for (int i = 0; i < pop.fitness_map.xlim; ++i)
+          for (int j = 0; j < pop.fitness_map.ylim; ++j)
+            if (pop.fitness_map.get(i, j) == selectedColorFitness)
+              pop.fitness_map.set(i, j, colorFitnessValue);
         
         // Swap color map entry to use new fitness value for the color
         colorMap[colorFitnessValue] = colorMap[selectedColorFitness];
@@ -567,13 +574,13 @@ public:
           return;
 
         // Change all instances of fitness being removed to 0
-        for (int i = 0; i < pop.xlim; ++i)
+        for (int i = 0; i < pop.fitness_map.xlim; ++i)
         {
-          for (int j = 0; j < pop.ylim; ++j)
+          for (int j = 0; j < pop.fitness_map.ylim; ++j)
           {
-            if (pop.fitness_map[j][i] == selectedColorFitness)
+            if (pop.fitness_map.get(i, j) == selectedColorFitness)
             {
-              pop.fitness_map[j][i] = 0;
+              pop.fitness_map.set(i, j, 0);
             }
           }
         }
@@ -620,7 +627,7 @@ public:
     popEntryButton = UI::Button(
       [this]()
       {
-        pop.n = popEntryValue;
+        pop.resize(popEntryValue);
         Redraw();
       },
       "Set Value",
@@ -721,10 +728,10 @@ public:
     // Update the population
     timeSinceLastEvolve += GetStepTime();
     if (fast)
-      pop.evolve(1, selectionText, tournamentSize);
+      pop.evolve(1, selectionMethod[0], tournamentSize);
     else if (timeSinceLastEvolve >= 1000)
     {
-      pop.evolve(1, selectionText, tournamentSize);
+      pop.evolve(1, selectionMethod[0], tournamentSize);
       timeSinceLastEvolve = 0.0;
     }
 
@@ -734,12 +741,12 @@ public:
   // Function that draws the fitness landscape as a background
   void DrawFitnessMap()
   {
-    double unit = csize / pop.xlim;
+    double unit = csize / pop.fitness_map.xlim;
     std::string border;
 
-    for (int i = 0; i < pop.xlim; ++i)
+    for (int i = 0; i < pop.fitness_map.xlim; ++i)
     {
-      for (int j = 0; j < pop.ylim; ++j)
+      for (int j = 0; j < pop.fitness_map.ylim; ++j)
       {
         border = "black";
 
@@ -747,7 +754,7 @@ public:
         if (selected.contains(std::pair<int, int>(i, j)))
           border = "red";
 
-        fscape.Rect(unit * i, unit * j, unit, unit, colorMap[pop.fitness_map[j][i]], border);
+        fscape.Rect(unit * i, unit * j, unit, unit, colorMap[pop.fitness_map.get(i, j)], border);
       }
     }
   }
@@ -755,7 +762,7 @@ public:
   // Function to draw the population on the fitness landscape
   void DrawPopulation()
   {
-    double unit = csize / pop.xlim;
+    double unit = csize / pop.fitness_map.xlim;
 
     for (int i = 0; i < pop.n; ++i)
     {
@@ -764,8 +771,9 @@ public:
       double yjitter = rng.GetDouble(-0.35, 0.35);
     
       // Choose x and y from current population, +0.5 to center on squares
-      double x = ((pop.first_pop) ? pop.pop1[i].x : pop.pop2[i].x) + 0.5;
-      double y = ((pop.first_pop) ? pop.pop1[i].y : pop.pop2[i].y) + 0.5;
+      uint32_t cell = (pop.first_pop) ? pop.pop1[i].cell : pop.pop2[i].cell;
+      double x = pop.fitness_map.getX(cell) + 0.5;
+      double y = pop.fitness_map.getY(cell) + 0.5;
 
       // Draw circles scaled to unit size for each organism
       fscape.Circle((x + xjitter) * unit, (y + yjitter) * unit, unit / 10.0, "red", "black");
@@ -844,7 +852,7 @@ public:
   {
     if (mode == POP)
     {
-      double unit = csize / pop.xlim;
+      double unit = csize / pop.fitness_map.xlim;
     
       // Set start tile
       startTileX = (x / unit);
@@ -857,14 +865,14 @@ public:
       if (colorSelected >= 0)
       {
         // Check the click location for drawing, same as MouseMove
-        double unit = csize / pop.xlim;
+        double unit = csize / pop.fitness_map.xlim;
         int tileX = (x / unit);
         int tileY = (y / unit);
 
         // Color tile with new color
-        if (pop.fitness_map[tileY][tileX] != selectedColorFitness)
+        if (pop.fitness_map.get(tileX, tileY) != selectedColorFitness)
         {
-          pop.fitness_map[tileY][tileX] = selectedColorFitness;
+          pop.fitness_map.set(tileX, tileY, selectedColorFitness);
           Redraw();
         }
       }
@@ -876,7 +884,7 @@ public:
   {
     if (mode == POP)
     {
-      double unit = csize / pop.xlim;
+      double unit = csize / pop.fitness_map.xlim;
     
       // Set end tile
       endTileX = (x / unit);
@@ -922,14 +930,14 @@ public:
   {
     if (mode == FIT && drawingOn && colorSelected >= 0)
     {
-      double unit = csize / pop.xlim;
+      double unit = csize / pop.fitness_map.xlim;
       int tileX = (x / unit);
       int tileY = (y / unit);
 
       // Color tile with new color
-      if (pop.fitness_map[tileY][tileX] != selectedColorFitness)
+      if (pop.fitness_map.get(tileX, tileY) != selectedColorFitness)
       {
-        pop.fitness_map[tileY][tileX] = selectedColorFitness;
+        pop.fitness_map.set(tileX, tileY, selectedColorFitness);
         Redraw();
       }
     }
@@ -942,11 +950,11 @@ public:
     colorMap.clear();
 
     // Add all fitness levels (std::map will auto sort)
-    for (int i = 0; i < pop.xlim; ++i)
+    for (int i = 0; i < pop.fitness_map.xlim; ++i)
     {
-      for (int j = 0; j < pop.ylim; ++j)
+      for (int j = 0; j < pop.fitness_map.ylim; ++j)
       {
-        colorMap.insert(std::pair<int, std::string>(pop.fitness_map[j][i], "black"));
+        colorMap.insert(std::pair<int, std::string>(pop.fitness_map.get(i, j), "black"));
       }
     }
     